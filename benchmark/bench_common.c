@@ -0,0 +1,70 @@
+//
+// Shared parts of the multithreaded benchmarks: loading a dataset and timing a round of threads.
+//
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench_common.h"
+#include "../include/cyclic.h"
+
+#define MAX_LINE_LENGTH 4096
+
+char** bench_load_keys(const char* path, size_t* count) {
+    FILE* file = fopen(path, "r");
+    if (!file) return NULL;
+
+    size_t capacity = 1024;
+    char** keys = malloc(capacity * sizeof(char*));
+    char line[MAX_LINE_LENGTH + 1];
+    *count = 0;
+    while (fgets(line, sizeof(line), file)) {
+        size_t len = strlen(line);
+        if (len > 0 && line[len - 1] == '\n') line[len - 1] = '\0';
+        if (*count == capacity) {
+            capacity *= 2;
+            keys = realloc(keys, capacity * sizeof(char*));
+        }
+        keys[(*count)++] = lexicographically_minimal_string_rotation(line);
+    }
+    fclose(file);
+    return keys;
+}
+
+void bench_free_keys(char** keys, size_t count) {
+    for (size_t i = 0; i < count; i++) free(keys[i]);
+    free(keys);
+}
+
+double elapsed_seconds(struct timespec start, struct timespec end) {
+    return (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+double bench_run_threads(size_t threads, void* (*task)(void*), void* target, char** keys, size_t count,
+                         size_t* found) {
+    pthread_t* workers = malloc(threads * sizeof(pthread_t));
+    BenchJob* jobs = malloc(threads * sizeof(BenchJob));
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t t = 0; t < threads; t++) {
+        jobs[t] = (BenchJob){ target, keys, count, t, threads, 0 };
+        pthread_create(&workers[t], NULL, task, &jobs[t]);
+    }
+    for (size_t t = 0; t < threads; t++) {
+        pthread_join(workers[t], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if (found) {
+        *found = 0;
+        for (size_t t = 0; t < threads; t++) *found += jobs[t].found;
+    }
+    free(jobs);
+    free(workers);
+    return elapsed_seconds(start, end);
+}
@@ -0,0 +1,35 @@
+//
+// Shared parts of the multithreaded benchmarks: loading a dataset and timing a round of threads.
+//
+
+#ifndef UNIEKE_CYCLISCHE_STRINGS_BENCH_COMMON_H
+#define UNIEKE_CYCLISCHE_STRINGS_BENCH_COMMON_H
+
+#include <stddef.h>
+#include <time.h>
+
+// What one benchmark thread works on. Threads take interleaved keys, so rotations of the same
+// string race on the same part of the structure.
+typedef struct {
+    void* target;     // Structure under test
+    char** keys;
+    size_t count;
+    size_t thread;
+    size_t threads;
+    size_t found;     // Written only when the thread is done, since adjacent jobs share cache lines
+} BenchJob;
+
+// Read the lines of path and canonicalize them up front, so only the structure is measured.
+// Returns NULL if the file cannot be opened.
+char** bench_load_keys(const char* path, size_t* count);
+
+void bench_free_keys(char** keys, size_t count);
+
+double elapsed_seconds(struct timespec start, struct timespec end);
+
+// Run task on threads threads, each with its own BenchJob, and return the wall time.
+// If found is not NULL it receives the sum of the jobs' found counts.
+double bench_run_threads(size_t threads, void* (*task)(void*), void* target, char** keys, size_t count,
+                         size_t* found);
+
+#endif //UNIEKE_CYCLISCHE_STRINGS_BENCH_COMMON_H
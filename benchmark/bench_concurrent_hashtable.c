@@ -0,0 +1,98 @@
+//
+// Contention benchmark for the concurrent hashtable: inserts the canonical rotations of a generator
+// dataset (see data/generator.py) with 1 up to N threads, then looks every key up again with as many
+// threads. The same inserts into the plain hashtable behind one global mutex serve as the baseline.
+//
+// gcc -std=c17 -O2 -pthread benchmark/bench_concurrent_hashtable.c benchmark/bench_common.c src/concurrent_hashtable.c src/hashtable.c src/cyclic.c src/utils.c -o bench_concurrent_hashtable
+// ./bench_concurrent_hashtable large.in 8
+//
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench_common.h"
+#include "../include/concurrent_hashtable.h"
+#include "../include/hashtable.h"
+
+typedef struct {
+    HashTable* table;
+    pthread_mutex_t lock;
+} LockedTable;
+
+void* insert_keys(void* arg) {
+    BenchJob* job = arg;
+    for (size_t i = job->thread; i < job->count; i += job->threads) {
+        concurrent_hashtable_add(job->target, job->keys[i]);
+    }
+    return NULL;
+}
+
+void* search_keys(void* arg) {
+    BenchJob* job = arg;
+    size_t found = 0;  // Stored into the job once at the end, see BenchJob
+    for (size_t i = job->thread; i < job->count; i += job->threads) {
+        found += concurrent_hashtable_search(job->target, job->keys[i]);
+    }
+    job->found = found;
+    return NULL;
+}
+
+void* insert_keys_locked(void* arg) {
+    BenchJob* job = arg;
+    LockedTable* locked = job->target;
+    for (size_t i = job->thread; i < job->count; i += job->threads) {
+        pthread_mutex_lock(&locked->lock);
+        hashtable_add(locked->table, job->keys[i]);
+        pthread_mutex_unlock(&locked->lock);
+    }
+    return NULL;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <dataset.in> <max threads>\n", argv[0]);
+        return 1;
+    }
+
+    size_t max_threads = strtoul(argv[2], NULL, 10);
+    if (max_threads == 0) max_threads = 1;
+
+    size_t count;
+    char** keys = bench_load_keys(argv[1], &count);
+    if (!keys) {
+        fprintf(stderr, "Cannot open %s\n", argv[1]);
+        return 1;
+    }
+
+    printf("%zu keys from %s\n", count, argv[1]);
+    printf("threads  insert Mkeys/s  speedup  search Mkeys/s  speedup  global lock Mkeys/s  distinct\n");
+
+    double single_insert = 0, single_search = 0;
+    size_t expected = 0;
+    for (size_t threads = 1; threads <= max_threads; threads++) {
+        ConcurrentHashTable* table = concurrent_hashtable_init();
+        double insert = bench_run_threads(threads, insert_keys, table, keys, count, NULL);
+        size_t found;
+        double search = bench_run_threads(threads, search_keys, table, keys, count, &found);
+
+        LockedTable locked = { hashtable_init(), PTHREAD_MUTEX_INITIALIZER };
+        double baseline = bench_run_threads(threads, insert_keys_locked, &locked, keys, count, NULL);
+
+        size_t distinct = concurrent_hashtable_size(table);
+        if (threads == 1) {
+            single_insert = insert;
+            single_search = search;
+            expected = distinct;
+        }
+        printf("%7zu  %14.2f  %7.2f  %14.2f  %7.2f  %19.2f  %8zu%s\n", threads, count / insert / 1e6,
+               single_insert / insert, count / search / 1e6, single_search / search, count / baseline / 1e6,
+               distinct, distinct == expected && found == count ? "" : "  MISMATCH");
+
+        hashtable_free(locked.table);
+        concurrent_hashtable_free(table);
+    }
+
+    bench_free_keys(keys, count);
+    return 0;
+}
@@ -0,0 +1,61 @@
+//
+// Scaling benchmark for the lock-free trie: inserts the canonical rotations of a generator
+// dataset (see data/generator.py) with 1 up to N threads and reports the throughput.
+//
+// gcc -std=c17 -O2 -pthread benchmark/bench_concurrent_trie.c benchmark/bench_common.c src/concurrent_trie.c src/cyclic.c src/utils.c -o bench_concurrent_trie
+// ./bench_concurrent_trie large.in 8
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench_common.h"
+#include "../include/concurrent_trie.h"
+
+// Threads take interleaved keys, so rotations of the same string race on the same slots
+void* insert_keys(void* arg) {
+    BenchJob* job = arg;
+    for (size_t i = job->thread; i < job->count; i += job->threads) {
+        concurrent_trie_add(job->target, job->keys[i]);
+    }
+    return NULL;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <dataset.in> <max threads>\n", argv[0]);
+        return 1;
+    }
+
+    size_t max_threads = strtoul(argv[2], NULL, 10);
+    if (max_threads == 0) max_threads = 1;
+
+    size_t count;
+    char** keys = bench_load_keys(argv[1], &count);
+    if (!keys) {
+        fprintf(stderr, "Cannot open %s\n", argv[1]);
+        return 1;
+    }
+
+    printf("%zu keys from %s\n", count, argv[1]);
+    printf("threads  seconds  Mkeys/s  speedup  distinct\n");
+
+    double single = 0;
+    size_t expected = 0;
+    for (size_t threads = 1; threads <= max_threads; threads++) {
+        ConcurrentTrie* trie = concurrent_trie_init();
+        double seconds = bench_run_threads(threads, insert_keys, trie, keys, count, NULL);
+        size_t distinct = concurrent_trie_size(trie);
+        if (threads == 1) {
+            single = seconds;
+            expected = distinct;
+        }
+        printf("%7zu  %7.3f  %7.2f  %7.2f  %8zu%s\n", threads, seconds, count / seconds / 1e6, single / seconds,
+               distinct, distinct == expected ? "" : "  MISMATCH");
+
+        concurrent_trie_free(trie);
+    }
+
+    bench_free_keys(keys, count);
+    return 0;
+}
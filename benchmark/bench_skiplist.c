@@ -0,0 +1,69 @@
+//
+// Scaling benchmark for the lock-free skip list: inserts the canonical rotations of a generator
+// dataset (see data/generator.py) with 1 up to N threads and reports the throughput.
+//
+// gcc -std=c17 -O2 -pthread benchmark/bench_skiplist.c benchmark/bench_common.c src/skiplist.c src/cyclic.c src/utils.c -o bench_skiplist
+// ./bench_skiplist large.in 8
+//
+// The speedup only shows scaling while there are at least as many CPUs as threads. Rows with more
+// threads than CPUs are marked: there the threads take turns, and the run only checks that they agree.
+//
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "bench_common.h"
+#include "../include/skiplist.h"
+
+// Threads take interleaved keys, so rotations of the same string race on the same links
+void* insert_keys(void* arg) {
+    BenchJob* job = arg;
+    for (size_t i = job->thread; i < job->count; i += job->threads) {
+        skiplist_add(job->target, job->keys[i]);
+    }
+    return NULL;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <dataset.in> <max threads>\n", argv[0]);
+        return 1;
+    }
+
+    size_t max_threads = strtoul(argv[2], NULL, 10);
+    if (max_threads == 0) max_threads = 1;
+
+    size_t count;
+    char** keys = bench_load_keys(argv[1], &count);
+    if (!keys) {
+        fprintf(stderr, "Cannot open %s\n", argv[1]);
+        return 1;
+    }
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    printf("%zu keys from %s, %ld CPUs online\n", count, argv[1], cpus);
+    printf("threads  seconds  Mkeys/s  speedup  distinct\n");
+
+    double single = 0;
+    size_t expected = 0;
+    for (size_t threads = 1; threads <= max_threads; threads++) {
+        SkipList* list = skiplist_init();
+        double seconds = bench_run_threads(threads, insert_keys, list, keys, count, NULL);
+        size_t distinct = skiplist_size(list);
+        if (threads == 1) {
+            single = seconds;
+            expected = distinct;
+        }
+        printf("%7zu  %7.3f  %7.2f  %7.2f  %8zu%s%s\n", threads, seconds, count / seconds / 1e6, single / seconds,
+               distinct, distinct == expected ? "" : "  MISMATCH",
+               (long)threads > cpus ? "  more threads than CPUs" : "");
+
+        skiplist_free(list);
+    }
+
+    bench_free_keys(keys, count);
+    return 0;
+}
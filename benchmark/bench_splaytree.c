@@ -0,0 +1,152 @@
+//
+// Locality benchmark for the semi-splay tree against the red-black tree. Streams like those of
+// data/generator.py are built in memory, except that a reused line is taken from the most recent
+// lines with the given locality, and from all earlier lines otherwise. For every stream it reports
+// the average number of nodes an add visits (all lines and reused lines) and the time for all adds.
+//
+// gcc -std=c17 -O2 benchmark/bench_splaytree.c src/splaytree.c src/searchtree.c src/cyclic.c src/utils.c -o bench_splaytree
+// ./bench_splaytree 1000000 64
+//
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../include/cyclic.h"
+#include "../include/searchtree.h"
+#include "../include/splaytree.h"
+
+#define REUSE_CHANCE 0.5
+#define MIN_LINE_LENGTH 4
+#define MAX_LINE_LENGTH 64
+
+// Same generator as the tests, rand() is not good enough for long streams
+uint64_t rand_x = 1, rand_y = 2, rand_c = 3;
+uint64_t next_random() {
+    const uint64_t result = rand_y;
+    const __uint128_t t = 0xffa04e67b3c95d86 * (__uint128_t)rand_x + rand_c;
+    rand_x = rand_y;
+    rand_y = t;
+    rand_c = t >> 64;
+    return result;
+}
+
+double next_unit() {
+    return (double)(next_random() >> 11) / (double)(1ull << 53);
+}
+
+double elapsed_seconds(struct timespec start, struct timespec end) {
+    return (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+// Canonical keys of a stream, reused[i] tells whether line i was a rotation of an earlier line
+char** generate_stream(size_t count, size_t window, double locality, bool* reused) {
+    char** keys = malloc(count * sizeof(char*));
+    char** generated = malloc(count * sizeof(char*));
+    size_t generated_count = 0;
+    char line[MAX_LINE_LENGTH + 1];
+
+    for (size_t i = 0; i < count; i++) {
+        reused[i] = generated_count > 0 && next_unit() < REUSE_CHANCE;
+        if (reused[i]) {
+            size_t pool = generated_count;
+            if (next_unit() < locality && window < pool) pool = window;
+            const char* choice = generated[generated_count - 1 - next_random() % pool];
+            size_t len = strlen(choice);
+            size_t rotation = next_random() % len;
+            memcpy(line, choice + rotation, len - rotation);
+            memcpy(line + len - rotation, choice, rotation);
+            line[len] = '\0';
+            keys[i] = lexicographically_minimal_string_rotation(line);
+        } else {
+            size_t len = MIN_LINE_LENGTH + next_random() % (MAX_LINE_LENGTH - MIN_LINE_LENGTH + 1);
+            for (size_t j = 0; j < len; j++) {
+                line[j] = (char)(63 + next_random() % 64);
+            }
+            line[len] = '\0';
+            keys[i] = lexicographically_minimal_string_rotation(line);
+            generated[generated_count++] = keys[i];
+        }
+    }
+
+    free(generated);
+    return keys;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <lines> <window>\n", argv[0]);
+        return 1;
+    }
+    size_t count = strtoul(argv[1], NULL, 10);
+    size_t window = strtoul(argv[2], NULL, 10);
+    if (count == 0 || window == 0) {
+        fprintf(stderr, "Lines and window must be positive\n");
+        return 1;
+    }
+
+    const double localities[] = { 0.0, 0.5, 0.9, 0.99 };
+    bool* reused = malloc(count * sizeof(bool));
+
+    printf("%zu lines, reused lines come from the last %zu lines with the given locality\n", count, window);
+    printf("locality  tree        depth  reused depth  seconds\n");
+
+    for (size_t l = 0; l < sizeof(localities) / sizeof(localities[0]); l++) {
+        char** keys = generate_stream(count, window, localities[l], reused);
+
+        // Depth pass: how many nodes each add visits, measured just before the add
+        double depth[2] = { 0, 0 }, reused_depth[2] = { 0, 0 };
+        size_t reused_count = 0;
+        SearchTree* rb = searchtree_init();
+        SplayTree* splay = splaytree_init();
+        for (size_t i = 0; i < count; i++) {
+            size_t rb_depth = searchtree_depth(rb, keys[i]);
+            size_t splay_depth = splaytree_depth(splay, keys[i]);
+            depth[0] += rb_depth;
+            depth[1] += splay_depth;
+            if (reused[i]) {
+                reused_depth[0] += rb_depth;
+                reused_depth[1] += splay_depth;
+                reused_count++;
+            }
+            searchtree_add(rb, keys[i]);
+            splaytree_add(splay, keys[i]);
+        }
+        searchtree_free(rb);
+        splaytree_free(splay);
+
+        // Timing pass, without the depth probes
+        struct timespec start, end;
+        double seconds[2];
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        rb = searchtree_init();
+        for (size_t i = 0; i < count; i++) searchtree_add(rb, keys[i]);
+        searchtree_free(rb);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        seconds[0] = elapsed_seconds(start, end);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        splay = splaytree_init();
+        for (size_t i = 0; i < count; i++) splaytree_add(splay, keys[i]);
+        splaytree_free(splay);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        seconds[1] = elapsed_seconds(start, end);
+
+        const char* names[] = { "red-black", "semi-splay" };
+        for (size_t t = 0; t < 2; t++) {
+            printf("%8.2f  %-10s  %5.1f  %12.1f  %7.3f\n", localities[l], names[t], depth[t] / count,
+                   reused_count ? reused_depth[t] / reused_count : 0.0, seconds[t]);
+        }
+
+        for (size_t i = 0; i < count; i++) free(keys[i]);
+        free(keys);
+    }
+
+    free(reused);
+    return 0;
+}
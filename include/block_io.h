@@ -0,0 +1,67 @@
+#ifndef UNIEKE_CYCLISCHE_STRINGS_BLOCK_IO_H
+#define UNIEKE_CYCLISCHE_STRINGS_BLOCK_IO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define IO_BLOCK_SIZE (1 << 20)  // 1 MiB, the largest batch the spec allows
+#define IO_RING_DEPTH 4          // Blocks in flight per reader or writer on io_uring
+
+// One input line inside a reader's block, null-terminated in place of its newline
+typedef struct LineSlice {
+    char* data;
+    size_t length;
+    bool valid;     // Every character lies in the alphabet, see line_scan.h
+} LineSlice;
+
+// Reads a file descriptor in blocks of up to IO_BLOCK_SIZE bytes and splits them into lines without copying.
+// Newlines are found and the alphabet checked in one vectorized pass, see line_scan.h.
+typedef struct BlockReader BlockReader;
+
+BlockReader* block_reader_init(int fd);
+
+// Map fd from its current position on and split lines straight from the mapping, in blocks of the same size.
+// Returns NULL when fd is not a regular file with input left or cannot be mapped,
+// callers then fall back to block_reader_init.
+BlockReader* block_reader_map(int fd);
+
+// Read through io_uring, with IO_RING_DEPTH blocks read ahead while the caller processes the lines.
+// Regular files get all of those reads in flight at once, pipes one at a time, as two reads of a pipe could
+// complete in either order. Returns NULL when io_uring is not available, callers then fall back to block_reader_init.
+// Freeing such a reader before the input ended waits for the read in flight, as read_ahead_free does.
+BlockReader* block_reader_ring(int fd);
+
+// Read the next block and split it into its complete lines. Returns false at the end of the input.
+// The slices point into the reader's buffer and stay valid until the next call.
+// By default a block is only returned once it is full or the input ended.
+bool block_reader_next(BlockReader* reader, LineSlice** lines, size_t* count);
+
+// Take the buffer and slices of the last block away from the reader, so they stay valid after its next call,
+// and give it buffer, of IO_BLOCK_SIZE + 1 bytes, and lines, with room for line_capacity > 0 slices, to go on with.
+// Only the unfinished line is copied over. Not for mapped readers, whose lines lie in the mapping.
+void block_reader_exchange(BlockReader* reader, char** buffer, LineSlice** lines, size_t* line_capacity);
+
+// Return a partial block as soon as its first complete line has waited the given number of milliseconds
+// for more input, right away when 0. Has no effect on mapped input, which never blocks.
+void block_reader_set_max_latency(BlockReader* reader, int milliseconds);
+
+void block_reader_free(BlockReader* reader);
+
+// Collects output lines and writes them with a single write per flush, never more than IO_BLOCK_SIZE bytes at once
+typedef struct BlockWriter BlockWriter;
+
+BlockWriter* block_writer_init(int fd);
+
+// Write through io_uring: a flush queues the block and returns, with up to IO_RING_DEPTH blocks waiting to be written.
+// Returns NULL when io_uring is not available, callers then fall back to block_writer_init.
+BlockWriter* block_writer_ring(int fd);
+
+// Append a line and its newline, flushing first when the buffer cannot hold it
+void block_writer_append(BlockWriter* writer, const char* data, size_t length);
+
+void block_writer_flush(BlockWriter* writer);
+
+// Flush what is left and free the writer
+void block_writer_free(BlockWriter* writer);
+
+#endif
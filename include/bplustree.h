@@ -0,0 +1,20 @@
+#ifndef UNIEKE_CYCLISCHE_STRINGS_BPLUSTREE_H
+#define UNIEKE_CYCLISCHE_STRINGS_BPLUSTREE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Ordered set with the same interface as searchtree.h, backed by a B+-tree with cache-line sized nodes
+typedef struct BPlusTree BPlusTree;
+
+BPlusTree* bplustree_init();
+
+void bplustree_free(BPlusTree*);
+
+bool bplustree_search(const BPlusTree*, const char*);
+
+bool bplustree_add(BPlusTree*, const char*);
+
+size_t bplustree_size(BPlusTree*);
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef UNIEKE_CYCLISCHE_STRINGS_COMPACT_SEARCHTREE_H
+#define UNIEKE_CYCLISCHE_STRINGS_COMPACT_SEARCHTREE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Red-black tree with the same interface as searchtree.h, with nodes linked by 32-bit index
+// instead of pointer and without parent links, so a node takes 32 bytes instead of 48
+typedef struct CompactSearchTree CompactSearchTree;
+
+CompactSearchTree* compact_searchtree_init();
+
+void compact_searchtree_free(CompactSearchTree*);
+
+bool compact_searchtree_search(const CompactSearchTree*, const char*);
+
+bool compact_searchtree_add(CompactSearchTree*, const char*);
+
+size_t compact_searchtree_size(CompactSearchTree*);
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef UNIEKE_CYCLISCHE_STRINGS_CONCURRENT_HASHTABLE_H
+#define UNIEKE_CYCLISCHE_STRINGS_CONCURRENT_HASHTABLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Hashtable that several threads may add to and search at once. Adds lock one of many segments,
+// searches never lock or wait. Freeing is not thread-safe and must happen after all other calls have returned.
+typedef struct ConcurrentHashTable ConcurrentHashTable;
+
+ConcurrentHashTable* concurrent_hashtable_init();
+
+void concurrent_hashtable_free(ConcurrentHashTable*);
+
+bool concurrent_hashtable_search(const ConcurrentHashTable*, const char*);
+
+bool concurrent_hashtable_add(ConcurrentHashTable*, const char*);
+
+size_t concurrent_hashtable_size(ConcurrentHashTable*);
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef UNIEKE_CYCLISCHE_STRINGS_CONCURRENT_TRIE_H
+#define UNIEKE_CYCLISCHE_STRINGS_CONCURRENT_TRIE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Compressed trie that several threads may add to and search at once without locks.
+// Freeing is not thread-safe and must happen after all other calls have returned.
+typedef struct ConcurrentTrie ConcurrentTrie;
+
+ConcurrentTrie* concurrent_trie_init();
+
+void concurrent_trie_free(ConcurrentTrie*);
+
+bool concurrent_trie_search(const ConcurrentTrie*, const char*);
+
+bool concurrent_trie_add(ConcurrentTrie*, const char*);
+
+size_t concurrent_trie_size(ConcurrentTrie*);
+
+#endif
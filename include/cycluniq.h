@@ -0,0 +1,57 @@
+#ifndef UNIEKE_CYCLISCHE_STRINGS_CYCLUNIQ_H
+#define UNIEKE_CYCLISCHE_STRINGS_CYCLUNIQ_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "block_io.h"
+
+// The deduplication engine of the cycluniq program as a library: lines go in as they arrive,
+// and every line whose cyclic rotations were not seen before comes back through a callback.
+// sources-libcycluniq lists its sources, for example
+//   gcc -std=c17 -O2 -shared -fPIC -pthread $(cat sources-libcycluniq) -o libcycluniq.so
+typedef struct Cycluniq Cycluniq;
+
+typedef struct CycluniqOptions {
+    const char* reference;  // File whose lines' rotations are never emitted, or NULL
+    size_t jobs;            // Threads canonicalizing the lines, 0 or 1 for just the caller
+    size_t shards;          // Structures the set is split over by hash, 0 or 1 for one, at most SHARDED_SET_MAX_SHARDS
+    bool unordered;         // With shards, emit on the shard's worker instead of in input order
+} CycluniqOptions;
+
+typedef enum CycluniqError {
+    CYCLUNIQ_OK,
+    CYCLUNIQ_BAD_OPTIONS,
+    CYCLUNIQ_BAD_REFERENCE,         // The reference file could not be read
+    CYCLUNIQ_BAD_DATASTRUCTURE,     // The data structure type is unknown
+} CycluniqError;
+
+// Receives a new line, null-terminated, which only stays valid during the call.
+// Lines come in input order on the thread that pushed them, in lane 0. With unordered they come
+// from the shard workers instead, with the shard as lane; calls for the same lane never overlap.
+typedef void (*CycluniqEmit)(const char* line, size_t length, size_t lane, void* context);
+
+// An engine on the data structure type of struct_utils.c, options may be NULL for the defaults.
+// Returns NULL and sets *error, when error is not NULL, if the engine cannot be set up.
+Cycluniq* cycluniq_init(const char* type, const CycluniqOptions* options, CycluniqEmit emit, void* context,
+                        CycluniqError* error);
+
+// Feed the next length bytes of input, cut anywhere, also in the middle of a line.
+// The complete lines among them are emitted before the call returns, the unfinished last one is kept.
+// Lines are cut off after IO_BLOCK_SIZE - 1 bytes, as the program reading its input does.
+void cycluniq_push(Cycluniq* engine, const char* data, size_t length);
+
+// Feed lines that are already split, such as the blocks of a BlockReader, without copying them.
+// Must not be mixed with cycluniq_push while that holds an unfinished line.
+void cycluniq_push_lines(Cycluniq* engine, const LineSlice* lines, size_t count);
+
+// End the input: a last line without a newline is emitted as well. The seen rotations are kept,
+// so pushing on continues the same set.
+void cycluniq_finish(Cycluniq* engine);
+
+// Lines seen so far with characters outside the alphabet, see line_scan.h. They are processed byte for byte.
+size_t cycluniq_invalid_lines(const Cycluniq* engine);
+
+void cycluniq_free(Cycluniq* engine);
+
+#endif
@@ -16,4 +16,21 @@ bool hashtable_add(HashTable*, const char*);
 
 size_t hashtable_size(HashTable*);
 
+// The hash hashtable_add uses, for callers that compute it ahead of time (e.g. on another thread)
+unsigned int hashtable_hash(const char*);
+
+// hashtable_add with the key's hashtable_hash already known
+bool hashtable_add_hashed(HashTable*, const char*, unsigned int);
+
+// Immutable minimal perfect hash of the keys of a hashtable for read-only membership checks
+typedef struct FrozenHashTable FrozenHashTable;
+
+FrozenHashTable* hashtable_freeze(const HashTable*);
+
+bool frozen_hashtable_search(const FrozenHashTable*, const char*);
+
+size_t frozen_hashtable_size(const FrozenHashTable*);
+
+void frozen_hashtable_free(FrozenHashTable*);
+
 #endif
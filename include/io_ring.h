@@ -0,0 +1,38 @@
+#ifndef UNIEKE_CYCLISCHE_STRINGS_IO_RING_H
+#define UNIEKE_CYCLISCHE_STRINGS_IO_RING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Small io_uring queue on the raw system calls, for reads and writes from a fixed set of buffers.
+// The buffers are registered with the kernel when it allows, so they are not pinned again for every request.
+// Requests carry a tag chosen by the caller and complete with the result read or write would return, or -errno.
+typedef struct IoRing IoRing;
+
+typedef struct IoRingCompletion {
+    uint64_t tag;
+    int result;
+} IoRingCompletion;
+
+// A ring for up to count requests at once on the given buffers of size bytes each.
+// Returns NULL when io_uring is not available, callers then fall back to plain read and write.
+IoRing* io_ring_init(char** buffers, size_t count, size_t size);
+
+// Queue a read into or a write from length bytes at data, which lies in buffers[buffer].
+// offset is the file position, or -1 for the current position of a pipe or terminal.
+void io_ring_read(IoRing* ring, int fd, size_t buffer, char* data, size_t length, int64_t offset, uint64_t tag);
+
+void io_ring_write(IoRing* ring, int fd, size_t buffer, const char* data, size_t length, int64_t offset, uint64_t tag);
+
+// Hand the queued requests to the kernel without waiting for any of them
+void io_ring_submit(IoRing* ring);
+
+// Take the next completion, waiting at most timeout milliseconds for it, forever when negative.
+// Returns false when none arrived in time.
+bool io_ring_wait(IoRing* ring, int timeout, IoRingCompletion* completion);
+
+// Free the ring, no request may still be in flight
+void io_ring_free(IoRing* ring);
+
+#endif
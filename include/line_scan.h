@@ -0,0 +1,16 @@
+#ifndef UNIEKE_CYCLISCHE_STRINGS_LINE_SCAN_H
+#define UNIEKE_CYCLISCHE_STRINGS_LINE_SCAN_H
+
+#include <stdbool.h>
+
+#define ALPHABET_FIRST 63   // '?', the smallest character a line may hold
+#define ALPHABET_LAST 126   // '~', the largest
+
+// Find the first newline in [data, end) and return it, or end when there is none.
+// In the same pass, *valid is cleared if a byte before the newline lies outside the alphabet,
+// and when codes is not NULL it receives the 6-bit code (byte - ALPHABET_FIRST) of each of those bytes.
+// Codes are stored a whole vector at a time, so codes needs room for end - data bytes.
+// Uses AVX2 or SSE2 when the CPU has them, chosen once at run time by the first call.
+const char* line_scan(const char* data, const char* end, bool* valid, unsigned char* codes);
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef UNIEKE_CYCLISCHE_STRINGS_LSMTREE_H
+#define UNIEKE_CYCLISCHE_STRINGS_LSMTREE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Set with the same interface as searchtree.h, built for insert-heavy workloads: new keys go to a
+// small sorted buffer that is flushed into immutable sorted runs, which are merged level by level.
+// Every run carries a Bloom filter so most lookups skip the runs that cannot hold the key.
+// Searching updates the statistics, hence the non-const tree argument.
+typedef struct LsmTree LsmTree;
+
+// Cost counters since the tree was created
+typedef struct LsmStats {
+    size_t keys;                    // Keys in the set
+    size_t runs;                    // Sorted runs, one per non-empty level
+    size_t entries_written;         // Entries written into runs by flushes and merges
+    double write_amplification;     // entries_written per key
+    size_t lookups;                 // Membership checks, including the one every add does
+    size_t runs_searched;           // Binary searches in runs, after the Bloom filters
+    size_t bloom_skips;             // Runs skipped because their Bloom filter ruled the key out
+    double runs_per_lookup;         // runs_searched per lookup
+} LsmStats;
+
+LsmTree* lsmtree_init();
+
+void lsmtree_free(LsmTree*);
+
+bool lsmtree_search(LsmTree*, const char*);
+
+bool lsmtree_add(LsmTree*, const char*);
+
+size_t lsmtree_size(LsmTree*);
+
+void lsmtree_stats(const LsmTree*, LsmStats*);
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef UNIEKE_CYCLISCHE_STRINGS_READ_AHEAD_H
+#define UNIEKE_CYCLISCHE_STRINGS_READ_AHEAD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "block_io.h"
+
+#define READ_AHEAD_SLOTS 2  // One block being processed while the next one is read
+
+// Runs a BlockReader on its own thread, so the next block is read while the current one is processed.
+// Blocks are handed over through a lock-free single-producer single-consumer ring of READ_AHEAD_SLOTS slots,
+// whose buffers are exchanged with the reader's instead of copied, see block_reader_exchange.
+typedef struct ReadAhead ReadAhead;
+
+// Start reading ahead from reader, which the ReadAhead takes over. Mapped readers need no read-ahead,
+// and io_uring readers already keep their reads in flight, so only plain readers are taken.
+ReadAhead* read_ahead_init(BlockReader* reader);
+
+// Same contract as block_reader_next: the slices stay valid until the next call
+bool read_ahead_next(ReadAhead* ahead, LineSlice** lines, size_t* count);
+
+// Stop the reader thread and free it together with its BlockReader.
+// If the input has not ended, this waits for the read in progress to return.
+void read_ahead_free(ReadAhead* ahead);
+
+#endif
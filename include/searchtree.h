@@ -16,4 +16,22 @@ bool searchtree_add(SearchTree*, const char*);
 
 size_t searchtree_size(SearchTree*);
 
+// Add a batch of keys in sorted order, starting each key from the node of the previous one.
+// The bool array receives per key (in input order) whether it was new.
+void searchtree_insert_batch(SearchTree*, const char**, size_t, bool*);
+
+// Number of nodes a search for key visits. Meant for benchmarks.
+size_t searchtree_depth(const SearchTree*, const char*);
+
+// Immutable copy of a search tree in a cache-oblivious van Emde Boas layout for read-only membership checks
+typedef struct FrozenSearchTree FrozenSearchTree;
+
+FrozenSearchTree* searchtree_freeze(const SearchTree*);
+
+bool frozen_searchtree_search(const FrozenSearchTree*, const char*);
+
+size_t frozen_searchtree_size(const FrozenSearchTree*);
+
+void frozen_searchtree_free(FrozenSearchTree*);
+
 #endif
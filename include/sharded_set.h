@@ -0,0 +1,36 @@
+#ifndef UNIEKE_CYCLISCHE_STRINGS_SHARDED_SET_H
+#define UNIEKE_CYCLISCHE_STRINGS_SHARDED_SET_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "thread_pool.h"
+
+#define SHARDED_SET_MAX_SHARDS 64
+
+// Set of canonical keys split by hash over several data structures of one type from struct_utils.c.
+// A key always lands in the same shard, and shard s is only ever touched by worker s of the thread pool,
+// so the structures need no locks and each one sees its keys in input order.
+typedef struct ShardedSet ShardedSet;
+
+ShardedSet* sharded_set_init(const char* type, size_t shards);
+
+size_t sharded_set_shards(const ShardedSet* set);
+
+// The shard key belongs to, from a hash independent of the ones the structures use themselves
+unsigned int sharded_set_shard(const ShardedSet* set, const char* key);
+
+// Add a batch of keys on the workers of pool, which needs at least as many workers as there are shards.
+// shard_of[i] is sharded_set_shard of keys[i] and hashes[i] its hash_for_datastructure. NULL keys are skipped.
+// added[i] tells whether keys[i] was new. The keys are freed on their shard's worker once inserted.
+// When emit is not NULL, it is called on the shard's worker for every new key, with the key's index and shard.
+void sharded_set_add_batch(ShardedSet* set, ThreadPool* pool, char** keys, const unsigned int* hashes,
+                           const unsigned int* shard_of, size_t count, bool* added,
+                           void (*emit)(size_t index, size_t shard, void* context), void* context);
+
+// Total number of keys over all shards
+size_t sharded_set_size(const ShardedSet* set);
+
+void sharded_set_free(ShardedSet* set);
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef UNIEKE_CYCLISCHE_STRINGS_SKIPLIST_H
+#define UNIEKE_CYCLISCHE_STRINGS_SKIPLIST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Ordered set with the same interface as searchtree.h that several threads may add to and
+// search at once without locks. Freeing is not thread-safe and must happen after all other calls have returned.
+typedef struct SkipList SkipList;
+
+SkipList* skiplist_init();
+
+void skiplist_free(SkipList*);
+
+bool skiplist_search(const SkipList*, const char*);
+
+bool skiplist_add(SkipList*, const char*);
+
+size_t skiplist_size(SkipList*);
+
+// Call visit on every key in sorted order. Keys added while the walk runs may or may not be visited.
+void skiplist_for_each(const SkipList*, void (*visit)(const char* key, void* context), void* context);
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef UNIEKE_CYCLISCHE_STRINGS_SPLAYTREE_H
+#define UNIEKE_CYCLISCHE_STRINGS_SPLAYTREE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Ordered set with the same interface as searchtree.h, backed by a semi-splay tree.
+// Every access moves the key closer to the root, so keys used again soon are found quickly.
+// Searching restructures the tree, hence the non-const tree argument.
+typedef struct SplayTree SplayTree;
+
+SplayTree* splaytree_init();
+
+void splaytree_free(SplayTree*);
+
+bool splaytree_search(SplayTree*, const char*);
+
+bool splaytree_add(SplayTree*, const char*);
+
+size_t splaytree_size(SplayTree*);
+
+// Number of nodes a search for key would visit, without splaying. Meant for benchmarks.
+size_t splaytree_depth(const SplayTree*, const char*);
+
+#endif
@@ -6,13 +6,24 @@
 #define STRUCTS_H
 
 #include <stdbool.h>
+#include <stddef.h>
 
 void* init_datastructure(const char* type);
 
 bool add_to_datastructure(void* ds, const char* key, const char* type);
 
-bool search_in_datastructure(const void* ds, const char* key, const char* type);
+// Not const: searching a splay tree restructures it, and an LSM tree counts the lookup in its statistics
+bool search_in_datastructure(void* ds, const char* key, const char* type);
 
 void free_datastructure(void* ds, const char* type);
 
+bool add_rotation_to_datastructure(void* ds, const char* line, const char* type);
+
+void add_rotation_batch_to_datastructure(void* ds, char** lines, size_t count, const char* type, bool* added);
+
+unsigned int hash_for_datastructure(const char* key, const char* type);
+
+void add_canonical_batch_to_datastructure(void* ds, const char** keys, const unsigned int* hashes, size_t count,
+                                          const char* type, bool* added);
+
 #endif //STRUCTS_H
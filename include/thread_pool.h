@@ -0,0 +1,26 @@
+#ifndef UNIEKE_CYCLISCHE_STRINGS_THREAD_POOL_H
+#define UNIEKE_CYCLISCHE_STRINGS_THREAD_POOL_H
+
+#include <stddef.h>
+
+// Fixed set of worker threads for parallel loops over an index range.
+// Every worker starts on its own share of the range and steals chunks from the others once that runs out,
+// so items of very different cost still keep all workers busy.
+typedef struct ThreadPool ThreadPool;
+
+// A pool of the given number of workers, the thread calling thread_pool_run being one of them
+ThreadPool* thread_pool_init(size_t workers);
+
+// Call task on disjoint subranges covering [0, count) and return once all of them are done
+void thread_pool_run(ThreadPool* pool, size_t count, void (*task)(size_t begin, size_t end, void* context),
+                     void* context);
+
+// Call task once on every worker, with the worker's index from 0 up to the number of workers.
+// The same index always runs on the same thread, so a worker can own data that no other worker touches.
+void thread_pool_run_each(ThreadPool* pool, void (*task)(size_t worker, void* context), void* context);
+
+size_t thread_pool_workers(const ThreadPool* pool);
+
+void thread_pool_free(ThreadPool* pool);
+
+#endif
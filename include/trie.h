@@ -16,4 +16,23 @@ bool trie_add(Trie*, const char*);
 
 size_t trie_size(Trie*);
 
+// Search for the canonical (lexicographically minimal) rotation of a raw line,
+// canonicalizing while descending so a miss never builds the full rotation
+bool trie_search_rotation(const Trie*, const char*);
+
+// Add a batch of keys in sorted order, reusing the path shared with the previous key.
+// The bool array receives per key (in input order) whether it was new.
+void trie_insert_batch(Trie*, const char**, size_t, bool*);
+
+// Immutable double-array copy of a trie for read-only membership checks
+typedef struct FrozenTrie FrozenTrie;
+
+FrozenTrie* trie_freeze(const Trie*);
+
+bool frozen_trie_search(const FrozenTrie*, const char*);
+
+size_t frozen_trie_size(const FrozenTrie*);
+
+void frozen_trie_free(FrozenTrie*);
+
 #endif
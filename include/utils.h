@@ -5,6 +5,43 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 char* my_strdup(const char* s);
 
+// First 8 bytes of s packed big-endian (zero padded), so integer order equals string order
+uint64_t string_prefix(const char* s);
+
+// Compare two strings of known length and string_prefix whose first offset bytes are known to be equal.
+// lcp receives the length of their common prefix. The strings themselves are only read on a prefix tie.
+int string_compare_prefixed(const char* a, size_t a_length, uint64_t a_prefix,
+                            const char* b, size_t b_length, uint64_t b_prefix, size_t offset, size_t* lcp);
+
+// Slab allocator for the nodes (and key bytes) of a single data structure.
+// Nodes are handed out from large slabs, so they sit next to each other in
+// memory without per-node malloc headers, and the whole pool is released at
+// once instead of node by node.
+typedef struct NodePool NodePool;
+
+NodePool* pool_init(size_t node_size);
+
+void* pool_alloc(NodePool* pool);
+
+char* pool_strndup(NodePool* pool, const char* s, size_t len);
+
+void pool_free(NodePool* pool);
+
+// Thread-safe counterpart of NodePool for structures that several threads add to at once.
+// Every thread bumps through its own chunk, so allocations only contend when a chunk runs out.
+typedef struct SharedPool SharedPool;
+
+SharedPool* shared_pool_init();
+
+void* shared_pool_alloc(SharedPool* pool, size_t size);
+
+char* shared_pool_strndup(SharedPool* pool, const char* s, size_t len);
+
+void shared_pool_free(SharedPool* pool);
+
 #endif //UTILS_H
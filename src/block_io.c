@@ -0,0 +1,630 @@
+//
+// Block-based line input and output on plain file descriptors
+//
+
+#define _DEFAULT_SOURCE  // madvise
+
+#include "../include/block_io.h"
+#include "../include/io_ring.h"
+#include "../include/line_scan.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define INITIAL_LINE_CAPACITY 1024
+
+// A block read or written through io_uring
+typedef struct RingBlock {
+    char* data;             // IO_BLOCK_SIZE bytes, registered with the ring
+    int64_t offset;         // File position of data, -1 on a pipe
+    size_t length;          // Bytes read, or bytes to write
+    size_t done;            // Bytes already taken out of a read block, or already written
+    bool complete;          // The read came back, or the whole block was written
+} RingBlock;
+
+// The blocks of one reader or writer, used in turn: blocks head up to tail are in use, and requests are tagged with their block
+typedef struct RingBlocks {
+    IoRing* io;
+    RingBlock blocks[IO_RING_DEPTH];
+    size_t head;
+    size_t tail;
+    bool seekable;          // Requests go to explicit file positions, so several may be in flight
+    int64_t offset;         // File position of the next block
+} RingBlocks;
+
+// Set up the blocks and their ring, or return false when io_uring is not available
+static bool ring_blocks_init(RingBlocks* ring, int fd) {
+    char* buffers[IO_RING_DEPTH];
+    for (size_t i = 0; i < IO_RING_DEPTH; i++) {
+        buffers[i] = malloc(IO_BLOCK_SIZE);
+        if (!buffers[i]) {
+            fprintf(stderr, "Memory allocation failed for io_uring blocks\n");
+            exit(EXIT_FAILURE);
+        }
+        ring->blocks[i] = (RingBlock){ buffers[i], -1, 0, 0, false };
+    }
+    ring->io = io_ring_init(buffers, IO_RING_DEPTH, IO_BLOCK_SIZE);
+    if (!ring->io) {
+        for (size_t i = 0; i < IO_RING_DEPTH; i++) free(buffers[i]);
+        return false;
+    }
+
+    // Only regular files have positions to read and write at. Appending writes ignore the position,
+    // so those stay in order by going one at a time, like pipes.
+    struct stat info;
+    off_t position = lseek(fd, 0, SEEK_CUR);
+    int flags = fcntl(fd, F_GETFL);
+    ring->seekable = fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && position >= 0 && flags >= 0
+                     && !(flags & O_APPEND);
+    ring->offset = ring->seekable ? position : -1;
+    ring->head = 0;
+    ring->tail = 0;
+    return true;
+}
+
+// Wait for a request of the ring, at most timeout milliseconds or forever when negative.
+// Returns the block it belongs to with the result in *result, or NULL when the timeout passed first.
+static RingBlock* ring_blocks_reap(RingBlocks* ring, int timeout, int* result) {
+    IoRingCompletion completion;
+    if (!io_ring_wait(ring->io, timeout, &completion)) return NULL;
+    *result = completion.result;
+    return &ring->blocks[completion.tag % IO_RING_DEPTH];
+}
+
+// Free the ring once every request in flight has come back
+static void ring_blocks_free(RingBlocks* ring) {
+    io_ring_free(ring->io);
+    for (size_t i = 0; i < IO_RING_DEPTH; i++) free(ring->blocks[i].data);
+}
+
+struct BlockReader {
+    int fd;
+    char* buffer;           // IO_BLOCK_SIZE bytes plus room for a terminator after the last line
+    size_t used;            // Bytes in buffer, starting with the unfinished line of the previous block
+    size_t consumed;        // Bytes of buffer handed out as lines by the last call
+    int cut_byte;           // Byte overwritten by the terminator of a cut-off line, or -1
+    bool partial_valid;     // The unfinished line so far lies in the alphabet
+    bool eof;
+    int max_latency;        // Milliseconds a complete line may wait for the block to fill, or -1 to always fill it
+    LineSlice* lines;       // Slices of the last block
+    size_t line_capacity;
+
+    char* map;              // Private writable mapping from the page of the start position, NULL unless mapped
+    size_t map_size;
+    size_t map_position;    // Start of the first line not handed out yet
+    size_t map_released;    // Pages before this offset were given back to the kernel
+
+    RingBlocks* ring;       // Blocks read ahead through io_uring in ring mode, NULL otherwise
+    bool ring_end;          // A read came back empty, nothing more gets queued
+};
+
+BlockReader* block_reader_init(int fd) {
+    BlockReader* reader = malloc(sizeof(BlockReader));
+    if (!reader) {
+        fprintf(stderr, "Memory allocation failed for BlockReader\n");
+        exit(EXIT_FAILURE);
+    }
+
+    reader->fd = fd;
+    reader->buffer = malloc(IO_BLOCK_SIZE + 1);
+    reader->used = 0;
+    reader->consumed = 0;
+    reader->cut_byte = -1;
+    reader->partial_valid = true;
+    reader->eof = false;
+    reader->max_latency = -1;
+    reader->line_capacity = INITIAL_LINE_CAPACITY;
+    reader->lines = malloc(reader->line_capacity * sizeof(LineSlice));
+    reader->map = NULL;
+    reader->map_size = 0;
+    reader->map_position = 0;
+    reader->map_released = 0;
+    reader->ring = NULL;
+    reader->ring_end = false;
+    if (!reader->buffer || !reader->lines) {
+        fprintf(stderr, "Memory allocation failed for BlockReader\n");
+        exit(EXIT_FAILURE);
+    }
+    return reader;
+}
+
+BlockReader* block_reader_map(int fd) {
+    struct stat info;
+    off_t position = lseek(fd, 0, SEEK_CUR);
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || position < 0 || info.st_size <= position) return NULL;
+
+    // Input starts at the current file position, like a read would. The mapping starts at the page holding it.
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t start = (size_t)position / page * page;
+
+    // Private and writable, so newlines can be replaced by terminators without touching the file.
+    // That write copies the page, and nearly every page holds a newline, so the input is still copied once;
+    // what the mapping saves is the read calls. The copies are dropped block by block as the lines are used.
+    size_t size = (size_t)info.st_size - start;
+    char* map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, (off_t)start);
+    if (map == MAP_FAILED) return NULL;
+    madvise(map, size, MADV_SEQUENTIAL);
+
+    BlockReader* reader = block_reader_init(fd);
+    reader->map = map;
+    reader->map_size = size;
+    reader->map_position = (size_t)position - start;
+    return reader;
+}
+
+BlockReader* block_reader_ring(int fd) {
+    RingBlocks* ring = malloc(sizeof(RingBlocks));
+    if (!ring) {
+        fprintf(stderr, "Memory allocation failed for BlockReader\n");
+        exit(EXIT_FAILURE);
+    }
+    if (!ring_blocks_init(ring, fd)) {
+        free(ring);
+        return NULL;
+    }
+
+    BlockReader* reader = block_reader_init(fd);
+    reader->ring = ring;
+    return reader;
+}
+
+// Queue reads into the free blocks, all of them on a file, and on a pipe only when no read is in flight
+void block_reader_ring_queue(BlockReader* reader) {
+    RingBlocks* ring = reader->ring;
+    while (!reader->ring_end && ring->tail - ring->head < IO_RING_DEPTH) {
+        if (!ring->seekable && ring->tail > ring->head && !ring->blocks[(ring->tail - 1) % IO_RING_DEPTH].complete) {
+            break;
+        }
+        size_t index = ring->tail % IO_RING_DEPTH;
+        RingBlock* block = &ring->blocks[index];
+        *block = (RingBlock){ block->data, ring->offset, 0, 0, false };
+        io_ring_read(ring->io, reader->fd, index, block->data, IO_BLOCK_SIZE, block->offset, index);
+        if (ring->seekable) ring->offset += IO_BLOCK_SIZE;
+        ring->tail++;
+    }
+    io_ring_submit(ring->io);
+}
+
+// Take in one completed read, returns false when the timeout passed first
+bool block_reader_ring_reap(BlockReader* reader, int timeout) {
+    int result = 0;
+    RingBlock* block = ring_blocks_reap(reader->ring, timeout, &result);
+    if (!block) return false;
+
+    size_t index = block - reader->ring->blocks;
+    if (result == -EINTR || result == -EAGAIN) {
+        io_ring_read(reader->ring->io, reader->fd, index, block->data, IO_BLOCK_SIZE, block->offset, index);
+        io_ring_submit(reader->ring->io);
+        return true;
+    }
+    if (result < 0) {
+        fprintf(stderr, "Failed to read input: %s\n", strerror(-result));
+        exit(EXIT_FAILURE);
+    }
+    block->length = (size_t)result;
+    block->complete = true;
+    if (result == 0) reader->ring_end = true;
+    return true;
+}
+
+// Wait for every read in flight, so their blocks can be reused or freed
+void block_reader_ring_drain(BlockReader* reader) {
+    RingBlocks* ring = reader->ring;
+    for (size_t i = ring->head; i < ring->tail; i++) {
+        while (!ring->blocks[i % IO_RING_DEPTH].complete) block_reader_ring_reap(reader, -1);
+    }
+}
+
+// Move up to space bytes of the blocks read ahead to dest, in input order, like read does. Returns 0 at the end.
+size_t block_reader_ring_take(BlockReader* reader, char* dest, size_t space) {
+    RingBlocks* ring = reader->ring;
+    for (;;) {
+        block_reader_ring_queue(reader);
+        if (ring->head == ring->tail) return 0;
+
+        RingBlock* block = &ring->blocks[ring->head % IO_RING_DEPTH];
+        if (!block->complete) {
+            block_reader_ring_reap(reader, -1);
+            continue;
+        }
+        if (block->length == 0) return 0;
+
+        size_t n = block->length - block->done < space ? block->length - block->done : space;
+        memcpy(dest, block->data + block->done, n);
+        block->done += n;
+        if (block->done == block->length) {
+            ring->head++;
+            // A short read of a file, such as one that is still growing, leaves the reads after it
+            // at the wrong positions. Those are dropped and the file is read again from here.
+            if (ring->seekable && block->length < IO_BLOCK_SIZE) {
+                block_reader_ring_drain(reader);
+                ring->tail = ring->head;
+                ring->offset = block->offset + (int64_t)block->length;
+                reader->ring_end = false;
+            }
+        }
+        return n;
+    }
+}
+
+static void block_reader_add_line(BlockReader* reader, char* data, size_t length, bool valid, size_t* count) {
+    if (*count == reader->line_capacity) {
+        reader->line_capacity *= 2;
+        reader->lines = realloc(reader->lines, reader->line_capacity * sizeof(LineSlice));
+        if (!reader->lines) {
+            fprintf(stderr, "Memory allocation failed for BlockReader lines\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    data[length] = '\0';
+    reader->lines[(*count)++] = (LineSlice){ data, length, valid };
+}
+
+// Add a line that was not scanned on the way, the rare cut-off and unterminated lines
+static void block_reader_add_unscanned_line(BlockReader* reader, char* data, size_t length, size_t* count) {
+    bool valid = true;
+    line_scan(data, data + length, &valid, NULL);
+    block_reader_add_line(reader, data, length, valid, count);
+}
+
+// Hand out the complete lines in the next IO_BLOCK_SIZE bytes of the mapping
+bool block_reader_next_mapped(BlockReader* reader, LineSlice** lines, size_t* count) {
+    // The lines of the previous block are done with, drop the private copies of their pages
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t release = reader->map_position / page * page;
+    if (release > reader->map_released) {
+        madvise(reader->map + reader->map_released, release - reader->map_released, MADV_DONTNEED);
+        reader->map_released = release;
+    }
+
+    *count = 0;
+    *lines = reader->lines;
+    if (reader->map_position == reader->map_size) return false;
+
+    char* line = reader->map + reader->map_position;
+    char* end = reader->map + reader->map_size;
+    if (end - line > IO_BLOCK_SIZE) end = line + IO_BLOCK_SIZE;
+    bool valid = true;
+    char* newline = (char*)line_scan(line, end, &valid, NULL);
+    while (newline != end) {
+        block_reader_add_line(reader, line, newline - line, valid, count);
+        line = newline + 1;
+        valid = true;
+        newline = (char*)line_scan(line, end, &valid, NULL);
+    }
+    reader->map_position = line - reader->map;
+
+    // An over-long line, or a last line without a newline, has no byte of its own to hold the terminator.
+    // It is copied to the buffer and cut off exactly where the block reader would cut it.
+    if (*count == 0) {
+        size_t length = reader->map_size - reader->map_position;
+        if (length > IO_BLOCK_SIZE - 1) length = IO_BLOCK_SIZE - 1;
+        memcpy(reader->buffer, line, length);
+        block_reader_add_unscanned_line(reader, reader->buffer, length, count);
+        reader->map_position += length;
+    }
+
+    *lines = reader->lines;
+    return true;
+}
+
+void block_reader_set_max_latency(BlockReader* reader, int milliseconds) {
+    reader->max_latency = milliseconds;
+}
+
+// Wait until more input can be read without blocking, but no longer than deadline.
+// Returns false when the deadline passed first.
+bool block_reader_wait(BlockReader* reader, const struct timespec* deadline) {
+    for (;;) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long long remaining = (long long)(deadline->tv_sec - now.tv_sec) * 1000
+                              + (deadline->tv_nsec - now.tv_nsec) / 1000000;
+        if (remaining < 0) remaining = 0;
+
+        // On the ring, input is ready once the oldest read came back
+        if (reader->ring) {
+            block_reader_ring_queue(reader);
+            RingBlocks* ring = reader->ring;
+            if (ring->head == ring->tail || ring->blocks[ring->head % IO_RING_DEPTH].complete) return true;
+            if (!block_reader_ring_reap(reader, (int)remaining)) return false;
+            continue;
+        }
+
+        struct pollfd input = { reader->fd, POLLIN, 0 };
+        int ready = poll(&input, 1, (int)remaining);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "Failed to poll input: %s\n", strerror(errno));
+            exit(EXIT_FAILURE);
+        }
+        return ready > 0;
+    }
+}
+
+bool block_reader_next(BlockReader* reader, LineSlice** lines, size_t* count) {
+    if (reader->map) return block_reader_next_mapped(reader, lines, count);
+
+    // Keep the unfinished line of the previous block at the start of the buffer
+    memmove(reader->buffer, reader->buffer + reader->consumed, reader->used - reader->consumed);
+    reader->used -= reader->consumed;
+    reader->consumed = 0;
+    if (reader->cut_byte >= 0) {
+        reader->buffer[0] = (char)reader->cut_byte;
+        reader->cut_byte = -1;
+    }
+    *count = 0;
+    *lines = reader->lines;
+
+    // Read until the block is full, or in latency mode until the first complete line has waited long enough
+    struct timespec deadline;
+    for (;;) {
+        if (reader->eof) {
+            if (*count > 0) break;
+            if (reader->used == 0) return false;
+            // The input did not end with a newline
+            block_reader_add_line(reader, reader->buffer, reader->used, reader->partial_valid, count);
+            reader->consumed = reader->used;
+            break;
+        }
+
+        if (reader->used == IO_BLOCK_SIZE) {
+            if (*count > 0) break;
+            // A full buffer without a newline is cut off as one line, like fgets does with its buffer.
+            // The last byte stays behind, so the line and its newline still fit one output block.
+            unsigned char last = (unsigned char)reader->buffer[IO_BLOCK_SIZE - 1];
+            reader->cut_byte = last;
+            block_reader_add_unscanned_line(reader, reader->buffer, IO_BLOCK_SIZE - 1, count);
+            reader->consumed = IO_BLOCK_SIZE - 1;
+            reader->partial_valid = last >= ALPHABET_FIRST && last <= ALPHABET_LAST;
+            break;
+        }
+
+        if (*count > 0 && reader->max_latency >= 0 && !block_reader_wait(reader, &deadline)) break;
+
+        ssize_t n = reader->ring
+                    ? (ssize_t)block_reader_ring_take(reader, reader->buffer + reader->used, IO_BLOCK_SIZE - reader->used)
+                    : read(reader->fd, reader->buffer + reader->used, IO_BLOCK_SIZE - reader->used);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "Failed to read input: %s\n", strerror(errno));
+            exit(EXIT_FAILURE);
+        }
+        if (n == 0) {
+            reader->eof = true;
+            continue;
+        }
+
+        // Only the new bytes can hold newlines, the carried-over part was already scanned
+        size_t first_count = *count;
+        size_t start = reader->used;
+        reader->used += n;
+        char* line = reader->buffer + reader->consumed;
+        char* end = reader->buffer + reader->used;
+        bool valid = reader->partial_valid;
+        char* newline = (char*)line_scan(reader->buffer + start, end, &valid, NULL);
+        while (newline != end) {
+            block_reader_add_line(reader, line, newline - line, valid, count);
+            line = newline + 1;
+            valid = true;
+            newline = (char*)line_scan(line, end, &valid, NULL);
+        }
+        reader->consumed = line - reader->buffer;
+        reader->partial_valid = valid;
+
+        if (first_count == 0 && *count > 0 && reader->max_latency >= 0) {
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
+            deadline.tv_sec += reader->max_latency / 1000;
+            deadline.tv_nsec += (long)(reader->max_latency % 1000) * 1000000;
+            if (deadline.tv_nsec >= 1000000000) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000;
+            }
+        }
+    }
+
+    *lines = reader->lines;
+    return true;
+}
+
+void block_reader_exchange(BlockReader* reader, char** buffer, LineSlice** lines, size_t* line_capacity) {
+    if (reader->map) {
+        fprintf(stderr, "A mapped BlockReader has no buffer to exchange\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Only the unfinished line moves over, the terminator of a cut-off line included
+    char* spare = *buffer;
+    memcpy(spare, reader->buffer + reader->consumed, reader->used - reader->consumed);
+    reader->used -= reader->consumed;
+    reader->consumed = 0;
+    *buffer = reader->buffer;
+    reader->buffer = spare;
+
+    LineSlice* spare_lines = *lines;
+    size_t spare_capacity = *line_capacity;
+    *lines = reader->lines;
+    *line_capacity = reader->line_capacity;
+    reader->lines = spare_lines;
+    reader->line_capacity = spare_capacity;
+}
+
+void block_reader_free(BlockReader* reader) {
+    if (!reader) return;
+
+    if (reader->map) munmap(reader->map, reader->map_size);
+    if (reader->ring) {
+        block_reader_ring_drain(reader);
+        ring_blocks_free(reader->ring);
+        free(reader->ring);
+    }
+    free(reader->buffer);
+    free(reader->lines);
+    free(reader);
+}
+
+struct BlockWriter {
+    int fd;
+    char* buffer;           // In ring mode the block at ring->tail, which is not queued yet
+    size_t used;
+
+    RingBlocks* ring;       // Blocks written through io_uring in ring mode, NULL otherwise
+    size_t ring_submitted;  // Blocks before this one went to the kernel, the ones after wait their turn
+};
+
+BlockWriter* block_writer_init(int fd) {
+    BlockWriter* writer = malloc(sizeof(BlockWriter));
+    if (!writer) {
+        fprintf(stderr, "Memory allocation failed for BlockWriter\n");
+        exit(EXIT_FAILURE);
+    }
+
+    writer->fd = fd;
+    writer->buffer = malloc(IO_BLOCK_SIZE);
+    writer->used = 0;
+    writer->ring = NULL;
+    writer->ring_submitted = 0;
+    if (!writer->buffer) {
+        fprintf(stderr, "Memory allocation failed for BlockWriter\n");
+        exit(EXIT_FAILURE);
+    }
+    return writer;
+}
+
+BlockWriter* block_writer_ring(int fd) {
+    RingBlocks* ring = malloc(sizeof(RingBlocks));
+    if (!ring) {
+        fprintf(stderr, "Memory allocation failed for BlockWriter\n");
+        exit(EXIT_FAILURE);
+    }
+    if (!ring_blocks_init(ring, fd)) {
+        free(ring);
+        return NULL;
+    }
+
+    BlockWriter* writer = block_writer_init(fd);
+    free(writer->buffer);
+    writer->buffer = ring->blocks[0].data;
+    writer->ring = ring;
+    return writer;
+}
+
+// Queue the rest of a block that is not fully written yet
+void block_writer_ring_write(BlockWriter* writer, RingBlock* block) {
+    size_t index = block - writer->ring->blocks;
+    int64_t offset = block->offset < 0 ? -1 : block->offset + (int64_t)block->done;
+    io_ring_write(writer->ring->io, writer->fd, index, block->data + block->done, block->length - block->done, offset,
+                  index);
+}
+
+// Hand the waiting blocks to the kernel, all of them on a file, and on a pipe only when no write is in flight
+void block_writer_ring_queue(BlockWriter* writer) {
+    RingBlocks* ring = writer->ring;
+    while (writer->ring_submitted < ring->tail && (ring->seekable || writer->ring_submitted == ring->head)) {
+        block_writer_ring_write(writer, &ring->blocks[writer->ring_submitted % IO_RING_DEPTH]);
+        writer->ring_submitted++;
+    }
+    io_ring_submit(ring->io);
+}
+
+// Take in one completed write, waiting at most timeout milliseconds or forever when negative.
+// A short write is queued again for the bytes it left, and blocks are released in order once they
+// are completely written. Returns false when no write completed in time.
+bool block_writer_ring_reap(BlockWriter* writer, int timeout) {
+    RingBlocks* ring = writer->ring;
+    int result = 0;
+    RingBlock* block = ring_blocks_reap(ring, timeout, &result);
+    if (!block) return false;
+    if (result < 0 && result != -EINTR && result != -EAGAIN) {
+        fprintf(stderr, "Failed to write output: %s\n", strerror(-result));
+        exit(EXIT_FAILURE);
+    }
+    if (result > 0) block->done += (size_t)result;
+    if (block->done < block->length) {
+        block_writer_ring_write(writer, block);
+    }
+    else {
+        block->complete = true;
+        while (ring->head < writer->ring_submitted && ring->blocks[ring->head % IO_RING_DEPTH].complete) {
+            ring->head++;
+        }
+    }
+    block_writer_ring_queue(writer);
+    return true;
+}
+
+// Queue the buffer as a block and continue in the next free one, only waiting when all of them are taken
+void block_writer_ring_flush(BlockWriter* writer) {
+    RingBlocks* ring = writer->ring;
+    RingBlock* block = &ring->blocks[ring->tail % IO_RING_DEPTH];
+    *block = (RingBlock){ block->data, ring->offset, writer->used, 0, false };
+    if (ring->seekable) ring->offset += (int64_t)writer->used;
+    ring->tail++;
+    block_writer_ring_queue(writer);
+
+    // Take in the writes that are done already, so on a pipe the blocks queued behind them go out now
+    // and not only once the ring fills up
+    while (block_writer_ring_reap(writer, 0)) {
+    }
+    while (ring->tail - ring->head == IO_RING_DEPTH) {
+        block_writer_ring_reap(writer, -1);
+    }
+    writer->buffer = ring->blocks[ring->tail % IO_RING_DEPTH].data;
+    writer->used = 0;
+}
+
+void block_writer_flush(BlockWriter* writer) {
+    if (writer->ring) {
+        if (writer->used > 0) block_writer_ring_flush(writer);
+        return;
+    }
+
+    size_t written = 0;
+    while (written < writer->used) {
+        ssize_t n = write(writer->fd, writer->buffer + written, writer->used - written);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "Failed to write output: %s\n", strerror(errno));
+            exit(EXIT_FAILURE);
+        }
+        written += n;
+    }
+    writer->used = 0;
+}
+
+void block_writer_append(BlockWriter* writer, const char* data, size_t length) {
+    if (writer->used + length + 1 > IO_BLOCK_SIZE) {
+        block_writer_flush(writer);
+    }
+    // Lines never exceed the input block, so one always fits in an empty buffer
+    memcpy(writer->buffer + writer->used, data, length);
+    writer->buffer[writer->used + length] = '\n';
+    writer->used += length + 1;
+}
+
+void block_writer_free(BlockWriter* writer) {
+    if (!writer) return;
+
+    block_writer_flush(writer);
+    if (writer->ring) {
+        RingBlocks* ring = writer->ring;
+        while (ring->head < ring->tail) {
+            block_writer_ring_reap(writer, -1);
+        }
+        // Writes at explicit positions leave the file position alone, move it past the output as write would
+        if (ring->seekable && ring->tail > 0) lseek(writer->fd, ring->offset, SEEK_SET);
+        ring_blocks_free(ring);
+        free(ring);
+    }
+    else {
+        free(writer->buffer);
+    }
+    free(writer);
+}
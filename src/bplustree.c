@@ -0,0 +1,251 @@
+//
+// B+-tree alternative for the red-black tree in searchtree.c
+//
+
+#include "../include/bplustree.h"
+#include "../include/utils.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Every node fills exactly eight cache lines
+#define BPLUS_NODE_SIZE 512
+#define BPLUS_LEAF_KEYS ((BPLUS_NODE_SIZE - 16) / 16)
+#define BPLUS_INNER_KEYS ((BPLUS_NODE_SIZE - 16) / 24)
+
+// Keys are compared on their first 8 bytes packed big-endian into an integer, so most
+// comparisons settle on the inline prefix and never touch the key string itself.
+
+typedef struct BPlusNode {
+    uint32_t count;     // Number of keys (leaf) or separators (inner node)
+    uint32_t is_leaf;
+} BPlusNode;
+
+typedef struct BPlusLeaf {
+    uint32_t count;
+    uint32_t is_leaf;
+    struct BPlusLeaf* next;                     // Right neighbour, keeps the keys in order
+    uint64_t prefixes[BPLUS_LEAF_KEYS];         // Inline prefixes of the keys
+    const char* keys[BPLUS_LEAF_KEYS];          // Keys, stored in the pool
+} BPlusLeaf;
+
+typedef struct BPlusInner {
+    uint32_t count;
+    uint32_t is_leaf;
+    uint64_t prefixes[BPLUS_INNER_KEYS];        // Inline prefixes of the separators
+    const char* separators[BPLUS_INNER_KEYS];   // Smallest key of children[i + 1]
+    BPlusNode* children[BPLUS_INNER_KEYS + 1];
+} BPlusInner;
+
+_Static_assert(sizeof(BPlusLeaf) <= BPLUS_NODE_SIZE, "B+-tree leaf exceeds its node size");
+_Static_assert(sizeof(BPlusInner) <= BPLUS_NODE_SIZE, "B+-tree inner node exceeds its node size");
+
+struct BPlusTree {
+    BPlusNode* root;
+    size_t size;
+    NodePool* pool;     // Owns every node and key of the tree
+};
+
+// Right half of a node that split, with the separator to insert in the parent
+typedef struct BPlusSplit {
+    BPlusNode* right;
+    uint64_t prefix;
+    const char* separator;
+} BPlusSplit;
+
+// Compare two keys, the strings are only read when their prefixes are equal
+int bplustree_compare(uint64_t prefix, const char* key, uint64_t other_prefix, const char* other) {
+    if (prefix != other_prefix) return prefix < other_prefix ? -1 : 1;
+    if ((prefix & 0xFF) == 0) return 0;  // Both keys end inside the prefix
+    return strcmp(key + 8, other + 8);
+}
+
+BPlusLeaf* bplustree_create_leaf(BPlusTree* tree) {
+    BPlusLeaf* leaf = pool_alloc(tree->pool);
+    leaf->count = 0;
+    leaf->is_leaf = true;
+    leaf->next = NULL;
+    return leaf;
+}
+
+BPlusInner* bplustree_create_inner(BPlusTree* tree) {
+    BPlusInner* inner = pool_alloc(tree->pool);
+    inner->count = 0;
+    inner->is_leaf = false;
+    return inner;
+}
+
+// Function to initialize the B+-tree
+BPlusTree* bplustree_init() {
+    BPlusTree* tree = malloc(sizeof(BPlusTree));
+    if (!tree) {
+        fprintf(stderr, "Memory allocation failed for BPlusTree\n");
+        exit(EXIT_FAILURE);
+    }
+
+    tree->pool = pool_init(BPLUS_NODE_SIZE);
+    tree->root = (BPlusNode*)bplustree_create_leaf(tree);
+    tree->size = 0;
+    return tree;
+}
+
+// Function to free the entire B+-tree, all nodes are released together with the pool
+void bplustree_free(BPlusTree* tree) {
+    if (tree) {
+        pool_free(tree->pool);
+        free(tree);
+    }
+}
+
+// Index of the child of inner that may hold the key
+uint32_t bplustree_child_index(const BPlusInner* inner, uint64_t prefix, const char* key) {
+    uint32_t i = 0;
+    while (i < inner->count && bplustree_compare(prefix, key, inner->prefixes[i], inner->separators[i]) >= 0) {
+        i++;
+    }
+    return i;
+}
+
+// Insert into a leaf, splitting it in two halves when it is full
+bool bplustree_insert_leaf(BPlusTree* tree, BPlusLeaf* leaf, uint64_t prefix, const char* key, BPlusSplit* split) {
+    uint32_t position = 0;
+    while (position < leaf->count) {
+        int cmp = bplustree_compare(prefix, key, leaf->prefixes[position], leaf->keys[position]);
+        if (cmp == 0) return false;  // Key already exists
+        if (cmp < 0) break;
+        position++;
+    }
+
+    const char* stored = pool_strndup(tree->pool, key, strlen(key));
+
+    if (leaf->count == BPLUS_LEAF_KEYS) {
+        // Move the upper half to a new right leaf, then insert in the half the key belongs to
+        BPlusLeaf* right = bplustree_create_leaf(tree);
+        uint32_t keep = (BPLUS_LEAF_KEYS + 1) / 2;
+        right->count = leaf->count - keep;
+        memcpy(right->prefixes, leaf->prefixes + keep, right->count * sizeof(uint64_t));
+        memcpy(right->keys, leaf->keys + keep, right->count * sizeof(char*));
+        leaf->count = keep;
+        right->next = leaf->next;
+        leaf->next = right;
+
+        if (position > keep) {
+            position -= keep;
+            leaf = right;
+        }
+        split->right = (BPlusNode*)right;
+    }
+
+    memmove(leaf->prefixes + position + 1, leaf->prefixes + position, (leaf->count - position) * sizeof(uint64_t));
+    memmove(leaf->keys + position + 1, leaf->keys + position, (leaf->count - position) * sizeof(char*));
+    leaf->prefixes[position] = prefix;
+    leaf->keys[position] = stored;
+    leaf->count++;
+
+    if (split->right) {
+        BPlusLeaf* right = (BPlusLeaf*)split->right;
+        split->prefix = right->prefixes[0];
+        split->separator = right->keys[0];
+    }
+    return true;
+}
+
+// Insert a separator and the child to its right at position in an inner node
+void bplustree_inner_put(BPlusInner* inner, uint32_t position, const BPlusSplit* child_split) {
+    memmove(inner->prefixes + position + 1, inner->prefixes + position, (inner->count - position) * sizeof(uint64_t));
+    memmove(inner->separators + position + 1, inner->separators + position, (inner->count - position) * sizeof(char*));
+    memmove(inner->children + position + 2, inner->children + position + 1, (inner->count - position) * sizeof(BPlusNode*));
+    inner->prefixes[position] = child_split->prefix;
+    inner->separators[position] = child_split->separator;
+    inner->children[position + 1] = child_split->right;
+    inner->count++;
+}
+
+// Recursive helper to insert a key below node, split describes the node's own split if any
+bool bplustree_insert(BPlusTree* tree, BPlusNode* node, uint64_t prefix, const char* key, BPlusSplit* split) {
+    if (node->is_leaf) {
+        return bplustree_insert_leaf(tree, (BPlusLeaf*)node, prefix, key, split);
+    }
+
+    BPlusInner* inner = (BPlusInner*)node;
+    uint32_t index = bplustree_child_index(inner, prefix, key);
+
+    BPlusSplit child_split = { NULL, 0, NULL };
+    if (!bplustree_insert(tree, inner->children[index], prefix, key, &child_split)) return false;
+    if (!child_split.right) return true;
+
+    if (inner->count < BPLUS_INNER_KEYS) {
+        bplustree_inner_put(inner, index, &child_split);
+        return true;
+    }
+
+    // Full inner node: the middle separator moves up, the separators after it go to a new right node
+    BPlusInner* right = bplustree_create_inner(tree);
+    uint32_t middle = BPLUS_INNER_KEYS / 2;
+    right->count = inner->count - middle - 1;
+    memcpy(right->prefixes, inner->prefixes + middle + 1, right->count * sizeof(uint64_t));
+    memcpy(right->separators, inner->separators + middle + 1, right->count * sizeof(char*));
+    memcpy(right->children, inner->children + middle + 1, (right->count + 1) * sizeof(BPlusNode*));
+    inner->count = middle;
+
+    split->right = (BPlusNode*)right;
+    split->prefix = inner->prefixes[middle];
+    split->separator = inner->separators[middle];
+
+    if (index <= middle) {
+        bplustree_inner_put(inner, index, &child_split);
+    } else {
+        bplustree_inner_put(right, index - middle - 1, &child_split);
+    }
+    return true;
+}
+
+// Add a key to the B+-tree
+bool bplustree_add(BPlusTree* tree, const char* key) {
+    if (!tree || !key) return false;
+
+    uint64_t prefix = string_prefix(key);
+    BPlusSplit split = { NULL, 0, NULL };
+    if (!bplustree_insert(tree, tree->root, prefix, key, &split)) return false;
+
+    if (split.right) {
+        // The root split, the tree grows one level
+        BPlusInner* root = bplustree_create_inner(tree);
+        root->count = 1;
+        root->prefixes[0] = split.prefix;
+        root->separators[0] = split.separator;
+        root->children[0] = tree->root;
+        root->children[1] = split.right;
+        tree->root = (BPlusNode*)root;
+    }
+
+    tree->size++;
+    return true;
+}
+
+// Search for a key in the B+-tree
+bool bplustree_search(const BPlusTree* tree, const char* key) {
+    if (!tree || !key) return false;
+
+    uint64_t prefix = string_prefix(key);
+    const BPlusNode* node = tree->root;
+    while (!node->is_leaf) {
+        const BPlusInner* inner = (const BPlusInner*)node;
+        node = inner->children[bplustree_child_index(inner, prefix, key)];
+    }
+
+    const BPlusLeaf* leaf = (const BPlusLeaf*)node;
+    for (uint32_t i = 0; i < leaf->count; i++) {
+        if (leaf->prefixes[i] == prefix && bplustree_compare(prefix, key, leaf->prefixes[i], leaf->keys[i]) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Return the size of the B+-tree
+size_t bplustree_size(BPlusTree* tree) {
+    return tree ? tree->size : 0;
+}
@@ -0,0 +1,260 @@
+//
+// Red-black tree of searchtree.c with a compact node layout
+//
+
+#include "../include/compact_searchtree.h"
+#include "../include/utils.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define COMPACT_NIL 0                      // Index 0 is never handed out and stands for no child
+#define COMPACT_RED ((uint32_t)1 << 31)    // Top bit of the left link holds the color
+#define COMPACT_INDEX_MASK (COMPACT_RED - 1)
+#define COMPACT_MAX_DEPTH 64               // A red-black tree of 2^31 nodes is at most 62 deep
+#define COMPACT_INITIAL_CAPACITY 1024
+
+typedef struct CompactNode {
+    const char* key;    // Key bytes, stored in the string pool
+    uint64_t prefix;    // First 8 bytes of key, big-endian, see string_prefix
+    uint32_t length;    // Length of key
+    uint32_t left;      // Index of the left child, tagged with COMPACT_RED
+    uint32_t right;     // Index of the right child
+} CompactNode;
+
+struct CompactSearchTree {
+    CompactNode* nodes;     // Growable node array, indices stay valid when it moves
+    uint32_t capacity;      // Allocated nodes
+    uint32_t count;         // Nodes in use, including the unused index 0
+    uint32_t root;          // Index of the root node
+    NodePool* strings;      // Owns every key of the tree
+};
+
+uint32_t compact_left(const CompactSearchTree* tree, uint32_t node) {
+    return tree->nodes[node].left & COMPACT_INDEX_MASK;
+}
+
+uint32_t compact_right(const CompactSearchTree* tree, uint32_t node) {
+    return tree->nodes[node].right;
+}
+
+void compact_set_left(CompactSearchTree* tree, uint32_t node, uint32_t child) {
+    tree->nodes[node].left = (tree->nodes[node].left & COMPACT_RED) | child;
+}
+
+void compact_set_right(CompactSearchTree* tree, uint32_t node, uint32_t child) {
+    tree->nodes[node].right = child;
+}
+
+// The nil index counts as black
+bool compact_is_red(const CompactSearchTree* tree, uint32_t node) {
+    return node != COMPACT_NIL && (tree->nodes[node].left & COMPACT_RED);
+}
+
+void compact_set_red(CompactSearchTree* tree, uint32_t node, bool red) {
+    if (red) tree->nodes[node].left |= COMPACT_RED;
+    else tree->nodes[node].left &= COMPACT_INDEX_MASK;
+}
+
+// Helper function to create a new red node, growing the node array when it is full
+uint32_t compact_searchtree_create_node(CompactSearchTree* tree, const char* key, size_t length, uint64_t prefix) {
+    if (tree->count == tree->capacity) {
+        if (tree->capacity > COMPACT_INDEX_MASK / 2) {
+            fprintf(stderr, "Too many nodes for CompactSearchTree\n");
+            exit(EXIT_FAILURE);
+        }
+        CompactNode* nodes = realloc(tree->nodes, 2 * (size_t)tree->capacity * sizeof(CompactNode));
+        if (!nodes) {
+            fprintf(stderr, "Memory allocation failed for CompactSearchTree nodes\n");
+            exit(EXIT_FAILURE);
+        }
+        tree->nodes = nodes;
+        tree->capacity *= 2;
+    }
+
+    uint32_t index = tree->count++;
+    CompactNode* node = &tree->nodes[index];
+    node->key = pool_strndup(tree->strings, key, length);
+    node->prefix = prefix;
+    node->length = length;
+    node->left = COMPACT_NIL | COMPACT_RED;
+    node->right = COMPACT_NIL;
+    return index;
+}
+
+// Function to initialize the compact search tree
+CompactSearchTree* compact_searchtree_init() {
+    CompactSearchTree* tree = malloc(sizeof(CompactSearchTree));
+    if (!tree) {
+        fprintf(stderr, "Memory allocation failed for CompactSearchTree\n");
+        exit(EXIT_FAILURE);
+    }
+
+    tree->nodes = malloc(COMPACT_INITIAL_CAPACITY * sizeof(CompactNode));
+    if (!tree->nodes) {
+        fprintf(stderr, "Memory allocation failed for CompactSearchTree nodes\n");
+        exit(EXIT_FAILURE);
+    }
+    tree->capacity = COMPACT_INITIAL_CAPACITY;
+    tree->count = 1;  // Reserve the nil index
+    tree->root = COMPACT_NIL;
+    tree->strings = pool_init(1);
+    return tree;
+}
+
+// Free the tree, the node array and the string pool go at once
+void compact_searchtree_free(CompactSearchTree* tree) {
+    if (tree) {
+        free(tree->nodes);
+        pool_free(tree->strings);
+        free(tree);
+    }
+}
+
+// Point the link of parent that held old_child at new_child, a nil parent means the root
+void compact_replace_child(CompactSearchTree* tree, uint32_t parent, uint32_t old_child, uint32_t new_child) {
+    if (parent == COMPACT_NIL) tree->root = new_child;
+    else if (compact_left(tree, parent) == old_child) compact_set_left(tree, parent, new_child);
+    else compact_set_right(tree, parent, new_child);
+}
+
+// Rotate left at node x whose parent is given, returns the node that takes its place
+uint32_t compact_rotate_left(CompactSearchTree* tree, uint32_t parent, uint32_t x) {
+    uint32_t y = compact_right(tree, x);
+    compact_set_right(tree, x, compact_left(tree, y));
+    compact_set_left(tree, y, x);
+    compact_replace_child(tree, parent, x, y);
+    return y;
+}
+
+// Rotate right at node x whose parent is given, returns the node that takes its place
+uint32_t compact_rotate_right(CompactSearchTree* tree, uint32_t parent, uint32_t x) {
+    uint32_t y = compact_left(tree, x);
+    compact_set_left(tree, x, compact_right(tree, y));
+    compact_set_right(tree, y, x);
+    compact_replace_child(tree, parent, x, y);
+    return y;
+}
+
+// Fix the red-black properties after inserting path[depth]. Without parent links the
+// ancestors come from path, the nodes visited by the descent with the root at path[0].
+void compact_insert_fixup(CompactSearchTree* tree, uint32_t* path, size_t depth) {
+    while (depth >= 2 && compact_is_red(tree, path[depth - 1])) {
+        uint32_t z = path[depth];
+        uint32_t parent = path[depth - 1];
+        uint32_t grandparent = path[depth - 2];
+        uint32_t above = depth >= 3 ? path[depth - 3] : COMPACT_NIL;
+
+        if (parent == compact_left(tree, grandparent)) {
+            uint32_t uncle = compact_right(tree, grandparent);
+            if (compact_is_red(tree, uncle)) {
+                // Case 1: uncle is red, recolor and move up the tree
+                compact_set_red(tree, parent, false);
+                compact_set_red(tree, uncle, false);
+                compact_set_red(tree, grandparent, true);
+                depth -= 2;
+                continue;
+            }
+            if (z == compact_right(tree, parent)) {
+                // Case 2: z is a right child, rotate to reduce to case 3
+                parent = compact_rotate_left(tree, grandparent, parent);
+            }
+            // Case 3: recolor and rotate right at the grandparent
+            compact_set_red(tree, parent, false);
+            compact_set_red(tree, grandparent, true);
+            compact_rotate_right(tree, above, grandparent);
+        } else {
+            uint32_t uncle = compact_left(tree, grandparent);
+            if (compact_is_red(tree, uncle)) {
+                // Mirror case 1
+                compact_set_red(tree, parent, false);
+                compact_set_red(tree, uncle, false);
+                compact_set_red(tree, grandparent, true);
+                depth -= 2;
+                continue;
+            }
+            if (z == compact_left(tree, parent)) {
+                // Mirror case 2
+                parent = compact_rotate_right(tree, grandparent, parent);
+            }
+            // Mirror case 3
+            compact_set_red(tree, parent, false);
+            compact_set_red(tree, grandparent, true);
+            compact_rotate_left(tree, above, grandparent);
+        }
+        break;
+    }
+    compact_set_red(tree, tree->root, false);  // Ensure the root is always black
+}
+
+// Add a key to the tree, the descent records its path for the fixup.
+// Comparisons skip the characters shared with both bounds, as in searchtree.c.
+bool compact_searchtree_add(CompactSearchTree* tree, const char* key) {
+    if (!tree || !key) return false;
+
+    size_t length = strlen(key);
+    uint64_t prefix = string_prefix(key);
+    uint32_t path[COMPACT_MAX_DEPTH];
+    size_t depth = 0;
+    uint32_t x = tree->root;
+    int cmp = 0;
+    size_t lower_lcp = 0, upper_lcp = 0;
+
+    while (x != COMPACT_NIL) {
+        const CompactNode* node = &tree->nodes[x];
+        size_t lcp;
+        cmp = string_compare_prefixed(key, length, prefix, node->key, node->length, node->prefix,
+                                      lower_lcp < upper_lcp ? lower_lcp : upper_lcp, &lcp);
+        if (cmp == 0) return false;  // Key already exists
+        path[depth++] = x;
+        if (cmp < 0) {
+            upper_lcp = lcp;
+            x = node->left & COMPACT_INDEX_MASK;
+        } else {
+            lower_lcp = lcp;
+            x = node->right;
+        }
+    }
+
+    // Create the node before linking it, creating may move the node array
+    uint32_t z = compact_searchtree_create_node(tree, key, length, prefix);
+    if (depth == 0) tree->root = z;
+    else if (cmp < 0) compact_set_left(tree, path[depth - 1], z);
+    else compact_set_right(tree, path[depth - 1], z);
+
+    path[depth] = z;
+    compact_insert_fixup(tree, path, depth);
+    return true;
+}
+
+// Search for a key in the tree
+bool compact_searchtree_search(const CompactSearchTree* tree, const char* key) {
+    if (!tree || !key) return false;
+
+    size_t length = strlen(key);
+    uint64_t prefix = string_prefix(key);
+    uint32_t x = tree->root;
+    size_t lower_lcp = 0, upper_lcp = 0;
+    while (x != COMPACT_NIL) {
+        const CompactNode* node = &tree->nodes[x];
+        size_t lcp;
+        int cmp = string_compare_prefixed(key, length, prefix, node->key, node->length, node->prefix,
+                                          lower_lcp < upper_lcp ? lower_lcp : upper_lcp, &lcp);
+        if (cmp == 0) return true;
+        if (cmp < 0) {
+            upper_lcp = lcp;
+            x = node->left & COMPACT_INDEX_MASK;
+        } else {
+            lower_lcp = lcp;
+            x = node->right;
+        }
+    }
+    return false;
+}
+
+// Return the number of keys in the tree
+size_t compact_searchtree_size(CompactSearchTree* tree) {
+    return tree ? tree->count - 1 : 0;
+}
@@ -0,0 +1,195 @@
+//
+// Concurrent hashtable: lock-striped segments that each resize on their own, and lookups without locks
+//
+
+#include "../include/concurrent_hashtable.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/utils.h"
+
+#define SEGMENT_BITS 6                  // 64 segments, picked by the top bits of the hash
+#define SEGMENT_COUNT (1 << SEGMENT_BITS)
+#define SEGMENT_INITIAL_SLOTS 64        // Per segment, always a power of two
+
+// A key with its hash, stored once in the pool and never moved or freed before the table
+typedef struct Entry {
+    uint64_t hash;
+    size_t length;
+    char key[];
+} Entry;
+
+// Open-addressing table with linear probing, filled at most half. A slot only ever changes from
+// NULL to an entry, so a lookup sees either nothing or a complete entry.
+typedef struct SegmentTable {
+    size_t mask;                        // Number of slots minus one
+    struct SegmentTable *retired;       // The smaller table this one replaced, see segment_grow
+    _Atomic(Entry *) slots[];
+} SegmentTable;
+
+typedef struct Segment {
+    _Alignas(64) pthread_mutex_t lock;  // Serializes the adds of this segment, a cache line of its own
+    _Atomic(SegmentTable *) table;
+    size_t count;                       // Keys in the segment, guarded by lock
+} Segment;
+
+struct ConcurrentHashTable {
+    Segment segments[SEGMENT_COUNT];
+    atomic_size_t size;                 // Total number of keys
+    SharedPool *pool;                   // Owns every entry
+};
+
+SegmentTable *segment_table_create(size_t slots) {
+    SegmentTable *table = malloc(sizeof(SegmentTable) + slots * sizeof(_Atomic(Entry *)));
+    if (!table) {
+        fprintf(stderr, "Memory allocation failed for ConcurrentHashTable segment\n");
+        exit(EXIT_FAILURE);
+    }
+    table->mask = slots - 1;
+    table->retired = NULL;
+    for (size_t i = 0; i < slots; i++) {
+        atomic_init(&table->slots[i], NULL);
+    }
+    return table;
+}
+
+// Initialize a new concurrent hashtable
+ConcurrentHashTable *concurrent_hashtable_init() {
+    ConcurrentHashTable *table = aligned_alloc(_Alignof(ConcurrentHashTable), sizeof(ConcurrentHashTable));
+    if (!table) {
+        fprintf(stderr, "Memory allocation failed for ConcurrentHashTable\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t i = 0; i < SEGMENT_COUNT; i++) {
+        pthread_mutex_init(&table->segments[i].lock, NULL);
+        atomic_init(&table->segments[i].table, segment_table_create(SEGMENT_INITIAL_SLOTS));
+        table->segments[i].count = 0;
+    }
+    atomic_init(&table->size, 0);
+    table->pool = shared_pool_init();
+    return table;
+}
+
+// 64-bit hash taking 8 bytes per step. The top bits pick the segment and the bottom bits the slot,
+// so both need to be well mixed.
+uint64_t concurrent_hashtable_hash(const char *key, size_t length) {
+    uint64_t hash = 0x9e3779b97f4a7c15 ^ length;
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        memcpy(&word, key + i, 8);
+        hash = (hash ^ word) * 0xff51afd7ed558ccd;
+        hash ^= hash >> 32;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, key + i, length - i);
+    hash = (hash ^ tail) * 0xc4ceb9fe1a85ec53;
+    hash ^= hash >> 29;
+    hash *= 0xff51afd7ed558ccd;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+// Probe for key, the table is never full so the probe always ends at a free slot
+Entry *segment_table_find(const SegmentTable *table, const char *key, size_t length, uint64_t hash) {
+    for (size_t i = hash & table->mask;; i = (i + 1) & table->mask) {
+        Entry *entry = atomic_load_explicit(&table->slots[i], memory_order_acquire);
+        if (!entry) return NULL;
+        if (entry->hash == hash && entry->length == length && memcmp(entry->key, key, length) == 0) return entry;
+    }
+}
+
+// Put an entry in the first free slot of its probe sequence, only called under the segment lock
+void segment_table_place(SegmentTable *table, Entry *entry) {
+    size_t i = entry->hash & table->mask;
+    while (atomic_load_explicit(&table->slots[i], memory_order_relaxed)) {
+        i = (i + 1) & table->mask;
+    }
+    atomic_store_explicit(&table->slots[i], entry, memory_order_release);
+}
+
+// Double the table of a segment under its lock. Lookups that already loaded the old table finish
+// in it: it still holds every key it had, it just gets no new ones. Because a lookup may still be
+// running in it, the old table is only freed together with the hashtable.
+SegmentTable *segment_grow(Segment *segment, SegmentTable *old) {
+    SegmentTable *table = segment_table_create((old->mask + 1) * 2);
+    for (size_t i = 0; i <= old->mask; i++) {
+        Entry *entry = atomic_load_explicit(&old->slots[i], memory_order_relaxed);
+        if (entry) segment_table_place(table, entry);
+    }
+    table->retired = old;
+    atomic_store_explicit(&segment->table, table, memory_order_release);
+    return table;
+}
+
+// Add a key if it is absent, safe to call from several threads at once
+bool concurrent_hashtable_add(ConcurrentHashTable *table, const char *key) {
+    if (!table || !key) return false;
+
+    size_t length = strlen(key);
+    uint64_t hash = concurrent_hashtable_hash(key, length);
+    Segment *segment = &table->segments[hash >> (64 - SEGMENT_BITS)];
+
+    // Keys that are already present never take the lock
+    if (segment_table_find(atomic_load_explicit(&segment->table, memory_order_acquire), key, length, hash)) {
+        return false;
+    }
+
+    pthread_mutex_lock(&segment->lock);
+    SegmentTable *segment_table = atomic_load_explicit(&segment->table, memory_order_relaxed);
+    if (segment_table_find(segment_table, key, length, hash)) {
+        pthread_mutex_unlock(&segment->lock);
+        return false;
+    }
+    if ((segment->count + 1) * 2 > segment_table->mask + 1) {
+        segment_table = segment_grow(segment, segment_table);
+    }
+
+    Entry *entry = shared_pool_alloc(table->pool, sizeof(Entry) + length + 1);
+    entry->hash = hash;
+    entry->length = length;
+    memcpy(entry->key, key, length + 1);
+    segment_table_place(segment_table, entry);
+    segment->count++;
+    pthread_mutex_unlock(&segment->lock);
+
+    atomic_fetch_add_explicit(&table->size, 1, memory_order_relaxed);
+    return true;
+}
+
+// Search for a key, wait-free: at most one pass over a table that is never full
+bool concurrent_hashtable_search(const ConcurrentHashTable *table, const char *key) {
+    if (!table || !key) return false;
+
+    size_t length = strlen(key);
+    uint64_t hash = concurrent_hashtable_hash(key, length);
+    const Segment *segment = &table->segments[hash >> (64 - SEGMENT_BITS)];
+    return segment_table_find(atomic_load_explicit(&segment->table, memory_order_acquire), key, length, hash) != NULL;
+}
+
+// Free the hashtable with every table a segment ever had, the entries are released together with the pool
+void concurrent_hashtable_free(ConcurrentHashTable *table) {
+    if (!table) return;
+
+    for (size_t i = 0; i < SEGMENT_COUNT; i++) {
+        SegmentTable *segment_table = atomic_load(&table->segments[i].table);
+        while (segment_table) {
+            SegmentTable *retired = segment_table->retired;
+            free(segment_table);
+            segment_table = retired;
+        }
+        pthread_mutex_destroy(&table->segments[i].lock);
+    }
+    shared_pool_free(table->pool);
+    free(table);
+}
+
+// Get the number of keys in the hashtable
+size_t concurrent_hashtable_size(ConcurrentHashTable *table) {
+    return table ? atomic_load(&table->size) : 0;
+}
@@ -0,0 +1,205 @@
+//
+// Lock-free variant of the compressed trie in trie.c
+//
+
+#include "../include/concurrent_trie.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/utils.h"
+
+#define CTRIE_LEAF ((uintptr_t)1)  // Low bit of a child slot: a word ends at this node
+
+// Edge to a child. Edges are immutable once published: an update builds new edges
+// and swaps them in through the child slot of the node they hang from.
+typedef struct CTrieEdge {
+    const char *label;              // Compressed string of the edge, stored in the pool
+    size_t length;                  // Length of label
+    struct CTrieNode *child;        // Node the edge leads to
+    const struct CTrieEdge *next;   // Next edge of the same node
+} CTrieEdge;
+
+// Nodes never move or split, only the contents of their child slot are replaced
+typedef struct CTrieNode {
+    _Atomic(uintptr_t) children;    // Head of the edge list, tagged with CTRIE_LEAF
+} CTrieNode;
+
+struct ConcurrentTrie {
+    CTrieNode *root;        // Root node of the trie
+    atomic_size_t size;     // Total number of words in the trie
+    SharedPool *pool;       // Owns every node, edge and label, including replaced edges
+};
+
+// Helper function to create a new node with the given child slot
+CTrieNode *concurrent_trie_create_node(ConcurrentTrie *trie, uintptr_t children) {
+    CTrieNode *node = shared_pool_alloc(trie->pool, sizeof(CTrieNode));
+    atomic_init(&node->children, children);
+    return node;
+}
+
+// Helper function to create a new edge
+CTrieEdge *concurrent_trie_create_edge(ConcurrentTrie *trie, const char *label, size_t length,
+                                       CTrieNode *child, const CTrieEdge *next) {
+    CTrieEdge *edge = shared_pool_alloc(trie->pool, sizeof(CTrieEdge));
+    edge->label = label;
+    edge->length = length;
+    edge->child = child;
+    edge->next = next;
+    return edge;
+}
+
+// Initialize a new concurrent trie
+ConcurrentTrie *concurrent_trie_init() {
+    ConcurrentTrie *trie = malloc(sizeof(ConcurrentTrie));
+    if (!trie) {
+        fprintf(stderr, "Memory allocation failed for ConcurrentTrie\n");
+        exit(EXIT_FAILURE);
+    }
+
+    trie->pool = shared_pool_init();
+    trie->root = concurrent_trie_create_node(trie, 0);
+    atomic_init(&trie->size, 0);
+
+    return trie;
+}
+
+// Helper function to find the longest common prefix of a key and an edge label
+size_t concurrent_trie_longest_common_prefix(const char *key, const char *label, size_t length) {
+    size_t i = 0;
+    while (i < length && key[i] && key[i] == label[i]) {
+        i++;
+    }
+    return i;
+}
+
+// Helper function to find the edge starting with character c
+const CTrieEdge *concurrent_trie_find_edge(uintptr_t children, char c) {
+    const CTrieEdge *edge = (const CTrieEdge *)(children & ~CTRIE_LEAF);
+    while (edge && edge->label[0] != c) {
+        edge = edge->next;
+    }
+    return edge;
+}
+
+// Build the edge list of children with target replaced by replacement.
+// Edges before target are copied, the ones after it are shared with the old list.
+const CTrieEdge *concurrent_trie_replace_edge(ConcurrentTrie *trie, uintptr_t children,
+                                              const CTrieEdge *target, const CTrieEdge *replacement) {
+    const CTrieEdge *head = (const CTrieEdge *)(children & ~CTRIE_LEAF);
+    if (head == target) return replacement;
+
+    CTrieEdge *copy = concurrent_trie_create_edge(trie, head->label, head->length, head->child, NULL);
+    const CTrieEdge *new_head = copy;
+    for (const CTrieEdge *edge = head->next; edge != target; edge = edge->next) {
+        CTrieEdge *next = concurrent_trie_create_edge(trie, edge->label, edge->length, edge->child, NULL);
+        copy->next = next;
+        copy = next;
+    }
+    copy->next = replacement;
+    return new_head;
+}
+
+// Add a word to the trie, safe to call from several threads at once.
+// Every change is a single compare-and-swap on one child slot: when two threads race on
+// the same slot only one wins, the other reloads the slot and continues from what it sees,
+// so concurrent adds of the same key agree on exactly one winner.
+bool concurrent_trie_add(ConcurrentTrie *trie, const char *key) {
+    if (!trie || !key) return false;
+
+    CTrieNode *node = trie->root;
+    uintptr_t children = atomic_load_explicit(&node->children, memory_order_acquire);
+
+    for (;;) {
+        uintptr_t desired;
+
+        if (!*key) {
+            if (children & CTRIE_LEAF) return false;
+            desired = children | CTRIE_LEAF;
+        } else {
+            const CTrieEdge *edge = concurrent_trie_find_edge(children, *key);
+
+            if (!edge) {
+                // No child shares the first character, publish a new leaf
+                size_t length = strlen(key);
+                const char *label = shared_pool_strndup(trie->pool, key, length);
+                CTrieNode *leaf = concurrent_trie_create_node(trie, CTRIE_LEAF);
+                const CTrieEdge *head = (const CTrieEdge *)(children & ~CTRIE_LEAF);
+                desired = (uintptr_t)concurrent_trie_create_edge(trie, label, length, leaf, head)
+                          | (children & CTRIE_LEAF);
+            } else {
+                size_t prefix_length = concurrent_trie_longest_common_prefix(key, edge->label, edge->length);
+
+                if (prefix_length == edge->length) {
+                    // Continue in the matching child
+                    key += prefix_length;
+                    node = edge->child;
+                    children = atomic_load_explicit(&node->children, memory_order_acquire);
+                    continue;
+                }
+
+                // Split the edge by putting a new node in the middle, the old child keeps its identity
+                const CTrieEdge *lower = concurrent_trie_create_edge(trie, edge->label + prefix_length,
+                                                                     edge->length - prefix_length, edge->child, NULL);
+                uintptr_t middle_children = (uintptr_t)lower;
+                if (key[prefix_length]) {
+                    size_t length = strlen(key + prefix_length);
+                    const char *label = shared_pool_strndup(trie->pool, key + prefix_length, length);
+                    CTrieNode *leaf = concurrent_trie_create_node(trie, CTRIE_LEAF);
+                    middle_children = (uintptr_t)concurrent_trie_create_edge(trie, label, length, leaf, lower);
+                } else {
+                    middle_children |= CTRIE_LEAF;
+                }
+
+                CTrieNode *middle = concurrent_trie_create_node(trie, middle_children);
+                const CTrieEdge *upper = concurrent_trie_create_edge(trie, edge->label, prefix_length, middle,
+                                                                     edge->next);
+                desired = (uintptr_t)concurrent_trie_replace_edge(trie, children, edge, upper)
+                          | (children & CTRIE_LEAF);
+            }
+        }
+
+        // On failure children is reloaded and the step is retried, the lost attempt stays in the pool
+        if (atomic_compare_exchange_weak_explicit(&node->children, &children, desired,
+                                                  memory_order_acq_rel, memory_order_acquire)) {
+            atomic_fetch_add_explicit(&trie->size, 1, memory_order_relaxed);
+            return true;
+        }
+    }
+}
+
+// Search for a word in the trie, never blocks and may run alongside adds
+bool concurrent_trie_search(const ConcurrentTrie *trie, const char *key) {
+    if (!trie || !key) return false;
+
+    const CTrieNode *node = trie->root;
+    for (;;) {
+        uintptr_t children = atomic_load_explicit((_Atomic(uintptr_t) *)&node->children, memory_order_acquire);
+        if (!*key) return children & CTRIE_LEAF;
+
+        const CTrieEdge *edge = concurrent_trie_find_edge(children, *key);
+        if (!edge) return false;
+
+        size_t prefix_length = concurrent_trie_longest_common_prefix(key, edge->label, edge->length);
+        if (prefix_length < edge->length) return false;
+
+        key += prefix_length;
+        node = edge->child;
+    }
+}
+
+// Free the trie, all nodes and edges are released together with the pool
+void concurrent_trie_free(ConcurrentTrie *trie) {
+    if (!trie) return;
+
+    shared_pool_free(trie->pool);
+    free(trie);
+}
+
+// Get the size of the trie
+size_t concurrent_trie_size(ConcurrentTrie *trie) {
+    return trie ? atomic_load(&trie->size) : 0;
+}
@@ -0,0 +1,375 @@
+//
+// Streaming deduplication of lines by cyclic rotation, the engine behind the cycluniq program
+//
+
+#include "../include/cycluniq.h"
+#include "../include/cyclic.h"
+#include "../include/line_scan.h"
+#include "../include/sharded_set.h"
+#include "../include/struct_utils.h"
+#include "../include/thread_pool.h"
+#include "../include/trie.h"
+#include "../include/utils.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define BATCH_SIZE 250              // Lines handed to the data structure at once
+#define INITIAL_LINE_CAPACITY 1024
+
+struct Cycluniq {
+    char* type;
+    void* structure;                // The set of canonical rotations, NULL with shards
+    ShardedSet* sharded;
+    FrozenTrie* reference;
+    ThreadPool* pool;               // With jobs or shards, NULL otherwise
+    bool unordered;
+    CycluniqEmit emit;
+    void* context;
+    size_t invalid_lines;
+
+    // Canonical forms of the block being processed, computed on the pool
+    const LineSlice* lines;
+    char** keys;                    // Canonical rotation per line, NULL when the reference corpus has it
+    unsigned int* hashes;           // hash_for_datastructure of every key
+    unsigned int* shard_of;         // sharded_set_shard of every key, with shards
+    bool* added;                    // Whether the line's rotation was new, with shards
+    size_t capacity;
+
+    // Input of cycluniq_push, split into lines the way a BlockReader splits its blocks
+    char* buffer;                   // IO_BLOCK_SIZE bytes plus a terminator, starting with the unfinished line
+    size_t used;
+    bool partial_valid;             // The unfinished line so far lies in the alphabet
+    LineSlice* split;
+    size_t split_capacity;
+};
+
+// Build the frozen set of canonical rotations of every line in a reference file
+FrozenTrie* cycluniq_load_reference(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    // Collect the canonical rotations in a trie first, then compact it for lookups only
+    Trie* trie = trie_init();
+    BlockReader* input = block_reader_map(fd);
+    if (input == NULL) {
+        input = block_reader_init(fd);
+    }
+    LineSlice* lines;
+    size_t line_count;
+    while (block_reader_next(input, &lines, &line_count))
+    {
+        for (size_t i = 0; i < line_count; i++)
+        {
+            char* minimal_rotation = lexicographically_minimal_string_rotation(lines[i].data);
+            trie_add(trie, minimal_rotation);
+            free(minimal_rotation);
+        }
+    }
+    block_reader_free(input);
+    close(fd);
+
+    FrozenTrie* reference = trie_freeze(trie);
+    trie_free(trie);
+    return reference;
+}
+
+Cycluniq* cycluniq_init(const char* type, const CycluniqOptions* options, CycluniqEmit emit, void* context,
+                        CycluniqError* error) {
+    CycluniqOptions defaults = { NULL, 1, 1, false };
+    if (!options) options = &defaults;
+    size_t jobs = options->jobs > 1 ? options->jobs : 1;
+    size_t shards = options->shards > 1 ? options->shards : 1;
+    CycluniqError failure = CYCLUNIQ_OK;
+    if (!type || !emit || shards > SHARDED_SET_MAX_SHARDS || (options->unordered && shards == 1)) {
+        failure = CYCLUNIQ_BAD_OPTIONS;
+    }
+
+    // Lines with a rotation in the reference corpus are never emitted
+    FrozenTrie* reference = NULL;
+    if (failure == CYCLUNIQ_OK && options->reference) {
+        reference = cycluniq_load_reference(options->reference);
+        if (!reference) failure = CYCLUNIQ_BAD_REFERENCE;
+    }
+
+    // The engine works on its own copy of type, the caller's string may go once this returns
+    char* own_type = NULL;
+    void* structure = NULL;
+    ShardedSet* sharded = NULL;
+    if (failure == CYCLUNIQ_OK) {
+        own_type = my_strdup(type);
+        if (!own_type) {
+            fprintf(stderr, "Memory allocation failed for Cycluniq\n");
+            exit(EXIT_FAILURE);
+        }
+        if (shards > 1) {
+            sharded = sharded_set_init(own_type, shards);
+        }
+        else {
+            structure = init_datastructure(own_type);
+        }
+        if (structure == NULL && sharded == NULL) failure = CYCLUNIQ_BAD_DATASTRUCTURE;
+    }
+
+    if (error) *error = failure;
+    if (failure != CYCLUNIQ_OK) {
+        frozen_trie_free(reference);
+        free(own_type);
+        return NULL;
+    }
+
+    Cycluniq* engine = calloc(1, sizeof(Cycluniq));
+    if (!engine) {
+        fprintf(stderr, "Memory allocation failed for Cycluniq\n");
+        exit(EXIT_FAILURE);
+    }
+    engine->type = own_type;
+    engine->structure = structure;
+    engine->sharded = sharded;
+    engine->reference = reference;
+    // With jobs, the lines of a block are canonicalized on a pool of threads and only the
+    // insertions run one after another, in input order, so the output stays the same.
+    // With shards, the insertions are spread as well: every shard's structure has its own worker,
+    // and the decisions are merged back into input order unless unordered drops that.
+    if (jobs > 1 || sharded) {
+        engine->pool = thread_pool_init(jobs > shards ? jobs : shards);
+    }
+    engine->unordered = options->unordered;
+    engine->emit = emit;
+    engine->context = context;
+
+    engine->buffer = malloc(IO_BLOCK_SIZE + 1);
+    engine->partial_valid = true;
+    engine->split_capacity = INITIAL_LINE_CAPACITY;
+    engine->split = malloc(engine->split_capacity * sizeof(LineSlice));
+    if (!engine->buffer || !engine->split) {
+        fprintf(stderr, "Memory allocation failed for Cycluniq\n");
+        exit(EXIT_FAILURE);
+    }
+    return engine;
+}
+
+// Add a batch of lines to the data structure and emit the ones whose rotation was new
+void cycluniq_process_batch(Cycluniq* engine, const LineSlice* lines, size_t line_count) {
+    bool added[BATCH_SIZE];
+    if (!engine->reference) {
+        char* pending[BATCH_SIZE];
+        for (size_t i = 0; i < line_count; i++)
+        {
+            pending[i] = lines[i].data;
+        }
+        add_rotation_batch_to_datastructure(engine->structure, pending, line_count, engine->type, added);
+    }
+    else {
+        // The canonical form looked up in the reference corpus is the one that gets added,
+        // lines the corpus already covers are left out as NULL keys
+        char* keys[BATCH_SIZE];
+        for (size_t i = 0; i < line_count; i++)
+        {
+            keys[i] = lexicographically_minimal_string_rotation(lines[i].data);
+            if (frozen_trie_search(engine->reference, keys[i])) {
+                free(keys[i]);
+                keys[i] = NULL;
+            }
+        }
+        add_canonical_batch_to_datastructure(engine->structure, (const char**)keys, NULL, line_count, engine->type,
+                                             added);
+        for (size_t i = 0; i < line_count; i++)
+        {
+            free(keys[i]);
+        }
+    }
+
+    // Emit the original lines whose canonical rotation was new, in input order
+    for (size_t i = 0; i < line_count; i++)
+    {
+        if (added[i]) {
+            engine->emit(lines[i].data, lines[i].length, 0, engine->context);
+        }
+    }
+}
+
+// Canonicalize and hash lines begin up to end of a block, runs on the workers of the thread pool
+void cycluniq_canonicalize_lines(size_t begin, size_t end, void* context) {
+    Cycluniq* engine = context;
+    for (size_t i = begin; i < end; i++)
+    {
+        char* minimal_rotation = lexicographically_minimal_string_rotation(engine->lines[i].data);
+        if (engine->reference && frozen_trie_search(engine->reference, minimal_rotation)) {
+            free(minimal_rotation);
+            minimal_rotation = NULL;
+        }
+        engine->keys[i] = minimal_rotation;
+        engine->hashes[i] = minimal_rotation ? hash_for_datastructure(minimal_rotation, engine->type) : 0;
+        if (engine->sharded && minimal_rotation) {
+            engine->shard_of[i] = sharded_set_shard(engine->sharded, minimal_rotation);
+        }
+    }
+}
+
+// Insert the canonical forms of a block in input order and emit the lines whose rotation was new
+void cycluniq_process_canonical_block(Cycluniq* engine, size_t line_count) {
+    bool added[BATCH_SIZE];
+    for (size_t i = 0; i < line_count; i += BATCH_SIZE)
+    {
+        size_t batch_count = line_count - i < BATCH_SIZE ? line_count - i : BATCH_SIZE;
+        add_canonical_batch_to_datastructure(engine->structure, (const char**)engine->keys + i, engine->hashes + i,
+                                             batch_count, engine->type, added);
+        for (size_t j = 0; j < batch_count; j++)
+        {
+            if (added[j]) {
+                engine->emit(engine->lines[i + j].data, engine->lines[i + j].length, 0, engine->context);
+            }
+            free(engine->keys[i + j]);
+        }
+    }
+}
+
+// Emit a new line on the worker of its shard, the emit callback of sharded_set_add_batch when unordered
+void cycluniq_emit_unordered(size_t index, size_t shard, void* context) {
+    Cycluniq* engine = context;
+    engine->emit(engine->lines[index].data, engine->lines[index].length, shard, engine->context);
+}
+
+void cycluniq_push_lines(Cycluniq* engine, const LineSlice* lines, size_t line_count) {
+    if (line_count == 0) return;  // Spares the thread pool a round that has nothing to add
+
+    for (size_t i = 0; i < line_count; i++)
+    {
+        engine->invalid_lines += !lines[i].valid;
+    }
+
+    if (!engine->pool) {
+        for (size_t i = 0; i < line_count; i += BATCH_SIZE)
+        {
+            size_t batch_count = line_count - i < BATCH_SIZE ? line_count - i : BATCH_SIZE;
+            cycluniq_process_batch(engine, lines + i, batch_count);
+        }
+        return;
+    }
+
+    if (line_count > engine->capacity) {
+        engine->capacity = line_count;
+        engine->keys = realloc(engine->keys, engine->capacity * sizeof(char*));
+        engine->hashes = realloc(engine->hashes, engine->capacity * sizeof(unsigned int));
+        engine->shard_of = realloc(engine->shard_of, engine->capacity * sizeof(unsigned int));
+        engine->added = realloc(engine->added, engine->capacity * sizeof(bool));
+        if (!engine->keys || !engine->hashes || !engine->shard_of || !engine->added) {
+            fprintf(stderr, "Memory allocation failed for canonical block\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    engine->lines = lines;
+    thread_pool_run(engine->pool, line_count, cycluniq_canonicalize_lines, engine);
+    if (engine->sharded && engine->unordered) {
+        sharded_set_add_batch(engine->sharded, engine->pool, engine->keys, engine->hashes, engine->shard_of,
+                              line_count, engine->added, cycluniq_emit_unordered, engine);
+    }
+    else if (engine->sharded) {
+        sharded_set_add_batch(engine->sharded, engine->pool, engine->keys, engine->hashes, engine->shard_of,
+                              line_count, engine->added, NULL, NULL);
+        for (size_t i = 0; i < line_count; i++)
+        {
+            if (engine->added[i]) {
+                engine->emit(lines[i].data, lines[i].length, 0, engine->context);
+            }
+        }
+    }
+    else {
+        cycluniq_process_canonical_block(engine, line_count);
+    }
+}
+
+void cycluniq_add_split_line(Cycluniq* engine, char* data, size_t length, bool valid, size_t* count) {
+    if (*count == engine->split_capacity) {
+        engine->split_capacity *= 2;
+        engine->split = realloc(engine->split, engine->split_capacity * sizeof(LineSlice));
+        if (!engine->split) {
+            fprintf(stderr, "Memory allocation failed for Cycluniq lines\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    data[length] = '\0';
+    engine->split[(*count)++] = (LineSlice){ data, length, valid };
+}
+
+void cycluniq_push(Cycluniq* engine, const char* data, size_t length) {
+    while (length > 0) {
+        // The pushed bytes are copied once, after the unfinished line, so every line gets a terminator
+        size_t n = IO_BLOCK_SIZE - engine->used < length ? IO_BLOCK_SIZE - engine->used : length;
+        memcpy(engine->buffer + engine->used, data, n);
+        data += n;
+        length -= n;
+
+        // Only the new bytes can hold newlines, the unfinished line was already scanned
+        size_t count = 0;
+        char* line = engine->buffer;
+        char* end = engine->buffer + engine->used + n;
+        bool valid = engine->partial_valid;
+        char* newline = (char*)line_scan(engine->buffer + engine->used, end, &valid, NULL);
+        while (newline != end) {
+            cycluniq_add_split_line(engine, line, newline - line, valid, &count);
+            line = newline + 1;
+            valid = true;
+            newline = (char*)line_scan(line, end, &valid, NULL);
+        }
+        engine->partial_valid = valid;
+        engine->used = end - line;
+        cycluniq_push_lines(engine, engine->split, count);
+        memmove(engine->buffer, line, engine->used);
+
+        if (engine->used == IO_BLOCK_SIZE) {
+            // A full buffer without a newline is cut off as one line, the last byte starts the next one
+            unsigned char last = (unsigned char)engine->buffer[IO_BLOCK_SIZE - 1];
+            valid = true;
+            line_scan(engine->buffer, engine->buffer + IO_BLOCK_SIZE - 1, &valid, NULL);
+            count = 0;
+            cycluniq_add_split_line(engine, engine->buffer, IO_BLOCK_SIZE - 1, valid, &count);
+            cycluniq_push_lines(engine, engine->split, count);
+            engine->buffer[0] = (char)last;
+            engine->used = 1;
+            engine->partial_valid = last >= ALPHABET_FIRST && last <= ALPHABET_LAST;
+        }
+    }
+}
+
+void cycluniq_finish(Cycluniq* engine) {
+    if (engine->used > 0) {
+        // The input did not end with a newline
+        size_t count = 0;
+        cycluniq_add_split_line(engine, engine->buffer, engine->used, engine->partial_valid, &count);
+        cycluniq_push_lines(engine, engine->split, count);
+    }
+    engine->used = 0;
+    engine->partial_valid = true;
+}
+
+size_t cycluniq_invalid_lines(const Cycluniq* engine) {
+    return engine->invalid_lines;
+}
+
+void cycluniq_free(Cycluniq* engine) {
+    if (!engine) return;
+
+    thread_pool_free(engine->pool);
+    if (engine->sharded) {
+        sharded_set_free(engine->sharded);
+    }
+    else {
+        free_datastructure(engine->structure, engine->type);
+    }
+    frozen_trie_free(engine->reference);
+    free(engine->keys);
+    free(engine->hashes);
+    free(engine->shard_of);
+    free(engine->added);
+    free(engine->buffer);
+    free(engine->split);
+    free(engine->type);
+    free(engine);
+}
@@ -4,6 +4,7 @@
 
 #include "../include/hashtable.h"
 #include "../include/utils.h"
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -25,6 +26,7 @@ struct HashTable
 };
 
 void hashtable_resize(HashTable* table);
+bool hashtable_search_hashed(const HashTable *table, const char *key, unsigned int hashval);
 void resize_bucket(struct Bucket* bucket);
 
 HashTable* hashtable_init()
@@ -75,22 +77,27 @@ unsigned int hash(const char *key) {
     return hashval;
 }
 
-// Functie om de index te berekenen op basis van de hashwaarde
-unsigned int get_bucket_index(HashTable *table, const char *key) {
-    return hash(key) % table->size;
+unsigned int hashtable_hash(const char *key) {
+    return hash(key);
 }
 
 bool hashtable_add(HashTable *table, const char *key) {
-    if (key == NULL || hashtable_search(table, key))
+    if (key == NULL)
+        return false;
+    return hashtable_add_hashed(table, key, hash(key));
+}
+
+// Add with a hash computed beforehand, so the key is hashed once instead of once for the search and once for the insert
+bool hashtable_add_hashed(HashTable *table, const char *key, unsigned int hashval) {
+    if (key == NULL || hashtable_search_hashed(table, key, hashval))
         return false;  // Sleutel bestaat al, voeg niet opnieuw toe
 
-    unsigned int index = get_bucket_index(table, key);
-    struct Bucket *bucket = table->buckets[index];
+    struct Bucket *bucket = table->buckets[hashval % table->size];
 
     // Als de bucket vol is, moet de tabel worden vergroot
     if (bucket->num_keys >= BUCKET_CAPACITY) {
         hashtable_resize(table);
-        return hashtable_add(table, key);  // Probeer opnieuw na resizing
+        return hashtable_add_hashed(table, key, hashval);  // Probeer opnieuw na resizing
     }
 
     // Voeg de sleutel toe aan de bucket
@@ -131,8 +138,11 @@ bool hashtable_search(const HashTable *table, const char *key) {
     if (key == NULL)
         return false;
 
-    unsigned int index = get_bucket_index((HashTable *)table, (char *)key);
-    struct Bucket *bucket = table->buckets[index];
+    return hashtable_search_hashed(table, key, hash(key));
+}
+
+bool hashtable_search_hashed(const HashTable *table, const char *key, unsigned int hashval) {
+    struct Bucket *bucket = table->buckets[hashval % table->size];
 
     // Zoek door de bucket
     for (size_t i = 0; i < bucket->num_keys; i++) {
@@ -143,8 +153,287 @@ bool hashtable_search(const HashTable *table, const char *key) {
     return false;  // Sleutel niet gevonden
 }
 
+// Immutable minimal perfect hash of a hashtable's keys (hash-and-displace, as in CHD): the keys are
+// spread over size / FROZEN_BUCKET_KEYS buckets, and every bucket stores one displacement that
+// moves all of its keys to slots no other key uses. The n keys thus fill exactly n slots, each
+// holding a fingerprint and the offset of the key in one blob of null-terminated keys.
+// A lookup reads the displacement of its bucket and its slot, and only compares the key bytes
+// when the fingerprints agree.
+// Displacements take 16 bits, about 3 bits per key. The last buckets to be placed see an almost
+// full table and may find no displacement in that range; their keys go to the remaining free
+// slots and are listed in a small overflow table, which costs those few keys one more lookup.
+#define FROZEN_BUCKET_KEYS 5
+#define FROZEN_MAX_SEEDS 64
+#define FROZEN_OVERFLOW UINT16_MAX  // Displacement of a bucket whose keys are in the overflow table
+
+typedef struct FrozenSlot {
+    uint32_t offset;        // Start of the key in the key blob
+    uint32_t fingerprint;   // Independent bits of the key's hash, rules out almost every absent key
+} FrozenSlot;
+
+typedef struct FrozenOverflow {
+    uint64_t hash;          // Full hash of the key, the table is sorted on it
+    size_t slot;
+} FrozenOverflow;
+
+struct FrozenHashTable {
+    uint16_t *displacements;    // One per bucket
+    FrozenSlot *slots;          // One per key
+    char *keys;                 // Null-terminated keys
+    FrozenOverflow *overflow;   // Keys of the buckets without a displacement
+    size_t overflow_count;
+    size_t bucket_count;
+    size_t size;                // Number of keys, equal to the number of slots
+    uint64_t seed;              // Hash seed the build succeeded with
+};
 
+uint64_t frozen_mix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccd;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53;
+    x ^= x >> 33;
+    return x;
+}
 
+// 64-bit FNV-1a of the key, seeded, with a final mix
+uint64_t frozen_hash(const char *key, uint64_t seed) {
+    uint64_t h = 0xcbf29ce484222325 ^ frozen_mix(seed);
+    for (; *key; key++) {
+        h = (h ^ (unsigned char)*key) * 0x100000001b3;
+    }
+    return frozen_mix(h);
+}
 
+size_t frozen_bucket(const FrozenHashTable *frozen, uint64_t h) {
+    return (h >> 32) % frozen->bucket_count;
+}
 
+size_t frozen_position(const FrozenHashTable *frozen, uint64_t h, uint16_t displacement) {
+    return frozen_mix(h + displacement * 0x9e3779b97f4a7c15) % frozen->size;
+}
+
+uint32_t frozen_fingerprint(uint64_t h) {
+    return (uint32_t)frozen_mix(h ^ 0x5851f42d4c957f2d);
+}
 
+int frozen_compare_overflow(const void *a, const void *b) {
+    const FrozenOverflow *x = a;
+    const FrozenOverflow *y = b;
+    return (x->hash > y->hash) - (x->hash < y->hash);
+}
+
+// Try to place every key with the current seed. Buckets go from large to small, so the buckets
+// that are hardest to place meet an almost empty table. Fails when two keys of a bucket hash alike.
+bool frozen_place(FrozenHashTable *frozen, const uint64_t *hashes) {
+    size_t n = frozen->size;
+    size_t buckets = frozen->bucket_count;
+
+    // Group the keys by bucket with a counting sort
+    size_t *bucket_start = calloc(buckets + 1, sizeof(size_t));
+    size_t *members = malloc(n * sizeof(size_t));
+    bool *taken = calloc(n, sizeof(bool));
+    if (!bucket_start || !members || !taken) {
+        fprintf(stderr, "Memory allocation failed for FrozenHashTable\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < n; i++) bucket_start[frozen_bucket(frozen, hashes[i]) + 1]++;
+    size_t max_size = 0;
+    for (size_t b = 0; b < buckets; b++) {
+        if (bucket_start[b + 1] > max_size) max_size = bucket_start[b + 1];
+        bucket_start[b + 1] += bucket_start[b];
+    }
+    size_t *fill = malloc(buckets * sizeof(size_t));
+    size_t *positions = malloc((max_size ? max_size : 1) * sizeof(size_t));
+    if (!fill || !positions) {
+        fprintf(stderr, "Memory allocation failed for FrozenHashTable\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(fill, bucket_start, buckets * sizeof(size_t));
+    for (size_t i = 0; i < n; i++) members[fill[frozen_bucket(frozen, hashes[i])]++] = i;
+
+    // Order the buckets by decreasing size, again with a counting sort
+    size_t *size_start = calloc(max_size + 2, sizeof(size_t));
+    size_t *order = malloc(buckets * sizeof(size_t));
+    if (!size_start || !order) {
+        fprintf(stderr, "Memory allocation failed for FrozenHashTable\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t b = 0; b < buckets; b++) size_start[max_size - (bucket_start[b + 1] - bucket_start[b]) + 1]++;
+    for (size_t s = 0; s <= max_size; s++) size_start[s + 1] += size_start[s];
+    for (size_t b = 0; b < buckets; b++) order[size_start[max_size - (bucket_start[b + 1] - bucket_start[b])]++] = b;
+
+    bool placed = true;
+    size_t overflow_buckets = 0;
+    for (size_t o = 0; o < buckets && placed; o++) {
+        size_t b = order[o];
+        size_t first = bucket_start[b], count = bucket_start[b + 1] - first;
+        frozen->displacements[b] = 0;
+        if (count == 0) continue;
+
+        for (size_t i = 0; i < count && placed; i++) {
+            for (size_t j = 0; j < i; j++) {
+                if (hashes[members[first + i]] == hashes[members[first + j]]) placed = false;
+            }
+        }
+        if (!placed) break;
+
+        // Every displacement gives each key a fresh pseudo-random slot
+        frozen->displacements[b] = FROZEN_OVERFLOW;
+        for (uint16_t d = 0; d < FROZEN_OVERFLOW; d++) {
+            bool fits = true;
+            for (size_t i = 0; i < count && fits; i++) {
+                positions[i] = frozen_position(frozen, hashes[members[first + i]], d);
+                if (taken[positions[i]]) fits = false;
+                for (size_t j = 0; j < i && fits; j++) {
+                    if (positions[j] == positions[i]) fits = false;
+                }
+            }
+            if (!fits) continue;
+
+            frozen->displacements[b] = d;
+            for (size_t i = 0; i < count; i++) {
+                size_t key = members[first + i];
+                taken[positions[i]] = true;
+                frozen->slots[positions[i]].fingerprint = frozen_fingerprint(hashes[key]);
+                // The offset is filled in by the caller once the key blob is laid out
+                frozen->slots[positions[i]].offset = (uint32_t)key;
+            }
+            break;
+        }
+        if (frozen->displacements[b] == FROZEN_OVERFLOW) order[overflow_buckets++] = b;
+    }
+
+    // The keys of the buckets left over fill the free slots in order
+    frozen->overflow_count = 0;
+    if (placed) {
+        for (size_t o = 0; o < overflow_buckets; o++) {
+            frozen->overflow_count += bucket_start[order[o] + 1] - bucket_start[order[o]];
+        }
+        free(frozen->overflow);
+        frozen->overflow = malloc((frozen->overflow_count ? frozen->overflow_count : 1) * sizeof(FrozenOverflow));
+        if (!frozen->overflow) {
+            fprintf(stderr, "Memory allocation failed for FrozenHashTable\n");
+            exit(EXIT_FAILURE);
+        }
+
+        size_t slot = 0, k = 0;
+        for (size_t o = 0; o < overflow_buckets; o++) {
+            for (size_t i = bucket_start[order[o]]; i < bucket_start[order[o] + 1]; i++) {
+                size_t key = members[i];
+                while (taken[slot]) slot++;
+                taken[slot] = true;
+                frozen->slots[slot].fingerprint = frozen_fingerprint(hashes[key]);
+                frozen->slots[slot].offset = (uint32_t)key;
+                frozen->overflow[k++] = (FrozenOverflow){ hashes[key], slot };
+            }
+        }
+        qsort(frozen->overflow, frozen->overflow_count, sizeof(FrozenOverflow), frozen_compare_overflow);
+    }
+
+    free(bucket_start);
+    free(members);
+    free(taken);
+    free(fill);
+    free(positions);
+    free(size_start);
+    free(order);
+    return placed;
+}
+
+FrozenHashTable *hashtable_freeze(const HashTable *table) {
+    if (!table) return NULL;
+
+    FrozenHashTable *frozen = malloc(sizeof(FrozenHashTable));
+    size_t n = table->num_entries;
+    char **keys = malloc((n ? n : 1) * sizeof(char *));
+    uint64_t *hashes = malloc((n ? n : 1) * sizeof(uint64_t));
+    if (!frozen || !keys || !hashes) {
+        fprintf(stderr, "Memory allocation failed for FrozenHashTable\n");
+        exit(EXIT_FAILURE);
+    }
+
+    size_t count = 0, key_bytes = 0;
+    for (size_t i = 0; i < table->size; i++) {
+        struct Bucket *bucket = table->buckets[i];
+        for (size_t j = 0; j < bucket->num_keys; j++) {
+            key_bytes += strlen(bucket->keys[j]) + 1;
+            keys[count++] = bucket->keys[j];
+        }
+    }
+    if (key_bytes > UINT32_MAX) {
+        fprintf(stderr, "Too many key bytes for FrozenHashTable\n");
+        exit(EXIT_FAILURE);
+    }
+
+    frozen->size = n;
+    frozen->bucket_count = n / FROZEN_BUCKET_KEYS + 1;
+    frozen->displacements = malloc(frozen->bucket_count * sizeof(uint16_t));
+    frozen->overflow = NULL;
+    frozen->slots = malloc((n ? n : 1) * sizeof(FrozenSlot));
+    frozen->keys = malloc(key_bytes + 1);
+    if (!frozen->displacements || !frozen->slots || !frozen->keys) {
+        fprintf(stderr, "Memory allocation failed for FrozenHashTable\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // A new seed only helps when two keys of one bucket share their whole 64-bit hash
+    bool placed = false;
+    for (frozen->seed = 0; frozen->seed < FROZEN_MAX_SEEDS && !placed; frozen->seed++) {
+        for (size_t i = 0; i < n; i++) hashes[i] = frozen_hash(keys[i], frozen->seed);
+        placed = frozen_place(frozen, hashes);
+    }
+    if (!placed) {
+        fprintf(stderr, "No perfect hash found for FrozenHashTable\n");
+        exit(EXIT_FAILURE);
+    }
+    frozen->seed--;
+
+    // Lay the keys out in slot order, so neighbouring slots point to neighbouring keys
+    size_t offset = 0;
+    for (size_t i = 0; i < n; i++) {
+        const char *key = keys[frozen->slots[i].offset];
+        size_t length = strlen(key) + 1;
+        memcpy(frozen->keys + offset, key, length);
+        frozen->slots[i].offset = (uint32_t)offset;
+        offset += length;
+    }
+
+    free(keys);
+    free(hashes);
+    return frozen;
+}
+
+bool frozen_hashtable_search(const FrozenHashTable *frozen, const char *key) {
+    if (!frozen || !key || frozen->size == 0) return false;
+
+    uint64_t h = frozen_hash(key, frozen->seed);
+    uint16_t displacement = frozen->displacements[frozen_bucket(frozen, h)];
+    size_t position;
+    if (displacement != FROZEN_OVERFLOW) {
+        position = frozen_position(frozen, h, displacement);
+    } else {
+        FrozenOverflow probe = { h, 0 };
+        const FrozenOverflow *entry = bsearch(&probe, frozen->overflow, frozen->overflow_count,
+                                              sizeof(FrozenOverflow), frozen_compare_overflow);
+        if (!entry) return false;
+        position = entry->slot;
+    }
+
+    const FrozenSlot *slot = &frozen->slots[position];
+    return slot->fingerprint == frozen_fingerprint(h) && strcmp(frozen->keys + slot->offset, key) == 0;
+}
+
+size_t frozen_hashtable_size(const FrozenHashTable *frozen) {
+    return frozen ? frozen->size : 0;
+}
+
+void frozen_hashtable_free(FrozenHashTable *frozen) {
+    if (!frozen) return;
+
+    free(frozen->displacements);
+    free(frozen->slots);
+    free(frozen->keys);
+    free(frozen->overflow);
+    free(frozen);
+}
@@ -0,0 +1,230 @@
+//
+// io_uring submission and completion queues driven through the raw system calls, without liburing
+//
+
+#define _DEFAULT_SOURCE  // syscall
+
+#include "../include/io_ring.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+struct IoRing {
+    int fd;
+    bool fixed;                     // The buffers are registered, requests use the fixed opcodes
+    unsigned int queued;            // Requests queued but not yet submitted
+    void* rings;                    // Submission and completion rings, mapped as one
+    size_t rings_size;
+    struct io_uring_sqe* sqes;
+    size_t sqes_size;
+
+    // Shared with the kernel: the kernel moves sq_head and cq_tail, this side sq_tail and cq_head
+    unsigned int* sq_head;
+    unsigned int* sq_tail;
+    unsigned int sq_mask;
+    unsigned int sq_entries;
+    unsigned int* cq_head;
+    unsigned int* cq_tail;
+    unsigned int cq_mask;
+    struct io_uring_cqe* cqes;
+};
+
+IoRing* io_ring_init(char** buffers, size_t count, size_t size) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = (int)syscall(__NR_io_uring_setup, (unsigned int)count, &params);
+    if (fd < 0) return NULL;  // No io_uring in this kernel, or it is turned off
+
+    // One mapping for both rings and timed waits, which older kernels lack
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_EXT_ARG)) {
+        close(fd);
+        return NULL;
+    }
+
+    IoRing* ring = malloc(sizeof(IoRing));
+    if (!ring) {
+        fprintf(stderr, "Memory allocation failed for IoRing\n");
+        exit(EXIT_FAILURE);
+    }
+    ring->fd = fd;
+    ring->queued = 0;
+
+    size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->rings_size = sq_size > cq_size ? sq_size : cq_size;
+    ring->rings = mmap(NULL, ring->rings_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                       IORING_OFF_SQ_RING);
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (ring->rings == MAP_FAILED || ring->sqes == MAP_FAILED) {
+        if (ring->rings != MAP_FAILED) munmap(ring->rings, ring->rings_size);
+        if (ring->sqes != MAP_FAILED) munmap(ring->sqes, ring->sqes_size);
+        close(fd);
+        free(ring);
+        return NULL;
+    }
+
+    char* base = ring->rings;
+    ring->sq_head = (unsigned int*)(base + params.sq_off.head);
+    ring->sq_tail = (unsigned int*)(base + params.sq_off.tail);
+    ring->sq_mask = *(unsigned int*)(base + params.sq_off.ring_mask);
+    ring->sq_entries = params.sq_entries;
+    ring->cq_head = (unsigned int*)(base + params.cq_off.head);
+    ring->cq_tail = (unsigned int*)(base + params.cq_off.tail);
+    ring->cq_mask = *(unsigned int*)(base + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*)(base + params.cq_off.cqes);
+
+    // Ring slot i always holds entry i
+    unsigned int* array = (unsigned int*)(base + params.sq_off.array);
+    for (unsigned int i = 0; i < params.sq_entries; i++) {
+        array[i] = i;
+    }
+
+    // Registering pins the buffers once. Kernels that charge it to a small RLIMIT_MEMLOCK refuse,
+    // the plain opcodes then pin them per request instead.
+    struct iovec* vectors = malloc(count * sizeof(struct iovec));
+    if (!vectors) {
+        fprintf(stderr, "Memory allocation failed for IoRing\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < count; i++) {
+        vectors[i] = (struct iovec){ buffers[i], size };
+    }
+    ring->fixed = syscall(__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS, vectors, (unsigned int)count) == 0;
+    free(vectors);
+
+    return ring;
+}
+
+void io_ring_queue(IoRing* ring, unsigned char opcode, int fd, size_t buffer, const char* data, size_t length,
+                   int64_t offset, uint64_t tag) {
+    unsigned int tail = *ring->sq_tail;
+    if (tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) == ring->sq_entries) {
+        fprintf(stderr, "IoRing submission queue overflow\n");
+        exit(EXIT_FAILURE);
+    }
+
+    struct io_uring_sqe* sqe = &ring->sqes[tail & ring->sq_mask];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)(uintptr_t)data;
+    sqe->len = (unsigned int)length;
+    sqe->off = (uint64_t)offset;
+    sqe->buf_index = (uint16_t)buffer;
+    sqe->user_data = tag;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ring->queued++;
+}
+
+void io_ring_read(IoRing* ring, int fd, size_t buffer, char* data, size_t length, int64_t offset, uint64_t tag) {
+    io_ring_queue(ring, ring->fixed ? IORING_OP_READ_FIXED : IORING_OP_READ, fd, buffer, data, length, offset, tag);
+}
+
+void io_ring_write(IoRing* ring, int fd, size_t buffer, const char* data, size_t length, int64_t offset, uint64_t tag) {
+    io_ring_queue(ring, ring->fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE, fd, buffer, data, length, offset, tag);
+}
+
+// Submit the queued requests and optionally wait for a completion. Returns false when the wait timed out.
+bool io_ring_enter(IoRing* ring, bool wait, int timeout) {
+    for (;;) {
+        unsigned int flags = wait ? IORING_ENTER_GETEVENTS : 0;
+        struct __kernel_timespec time = { timeout / 1000, (long long)(timeout % 1000) * 1000000 };
+        struct io_uring_getevents_arg argument = { 0, 0, 0, (uint64_t)(uintptr_t)&time };
+        void* extra = NULL;
+        size_t extra_size = 0;
+        if (wait && timeout >= 0) {
+            flags |= IORING_ENTER_EXT_ARG;
+            extra = &argument;
+            extra_size = sizeof(argument);
+        }
+
+        long submitted = syscall(__NR_io_uring_enter, ring->fd, ring->queued, wait ? 1 : 0, flags, extra, extra_size);
+        if (submitted < 0) {
+            if (errno == EINTR) continue;
+            if (errno == ETIME) return false;
+            fprintf(stderr, "Failed to submit to io_uring: %s\n", strerror(errno));
+            exit(EXIT_FAILURE);
+        }
+        ring->queued -= (unsigned int)submitted;
+        if (ring->queued == 0 || wait) return true;
+    }
+}
+
+void io_ring_submit(IoRing* ring) {
+    if (ring->queued > 0) io_ring_enter(ring, false, 0);
+}
+
+bool io_ring_wait(IoRing* ring, int timeout, IoRingCompletion* completion) {
+    for (;;) {
+        unsigned int head = *ring->cq_head;
+        if (head != __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE)) {
+            const struct io_uring_cqe* cqe = &ring->cqes[head & ring->cq_mask];
+            completion->tag = cqe->user_data;
+            completion->result = cqe->res;
+            __atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+            return true;
+        }
+        // Submit on its own first, a call that submits anything returns without reporting a timeout
+        io_ring_submit(ring);
+        if (timeout == 0) return false;
+        if (!io_ring_enter(ring, true, timeout)) {
+            timeout = 0;  // Take a completion that raced with the timeout, otherwise report it
+        }
+    }
+}
+
+void io_ring_free(IoRing* ring) {
+    if (!ring) return;
+
+    munmap(ring->sqes, ring->sqes_size);
+    munmap(ring->rings, ring->rings_size);
+    close(ring->fd);
+    free(ring);
+}
+
+#else
+
+// Without io_uring there is never a ring, so only io_ring_init is ever called
+
+IoRing* io_ring_init(char** buffers, size_t count, size_t size) {
+    (void)buffers;
+    (void)count;
+    (void)size;
+    return NULL;
+}
+
+void io_ring_read(IoRing* ring, int fd, size_t buffer, char* data, size_t length, int64_t offset, uint64_t tag) {
+    (void)ring; (void)fd; (void)buffer; (void)data; (void)length; (void)offset; (void)tag;
+}
+
+void io_ring_write(IoRing* ring, int fd, size_t buffer, const char* data, size_t length, int64_t offset, uint64_t tag) {
+    (void)ring; (void)fd; (void)buffer; (void)data; (void)length; (void)offset; (void)tag;
+}
+
+void io_ring_submit(IoRing* ring) {
+    (void)ring;
+}
+
+bool io_ring_wait(IoRing* ring, int timeout, IoRingCompletion* completion) {
+    (void)ring;
+    (void)timeout;
+    (void)completion;
+    return false;
+}
+
+void io_ring_free(IoRing* ring) {
+    (void)ring;
+}
+
+#endif
@@ -0,0 +1,109 @@
+//
+// Newline search fused with alphabet validation, vectorized where the CPU allows it
+//
+
+#include "../include/line_scan.h"
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+// Scalar scan, also used for the tail that does not fill a whole vector
+const char* line_scan_scalar(const char* data, const char* end, bool* valid, unsigned char* codes) {
+    for (; data < end; data++) {
+        unsigned char c = (unsigned char)*data;
+        if (c == '\n') return data;
+        if (c < ALPHABET_FIRST || c > ALPHABET_LAST) *valid = false;
+        if (codes) *codes++ = (unsigned char)(c - ALPHABET_FIRST);
+    }
+    return end;
+}
+
+#if defined(__x86_64__)
+
+// One vector compare per condition: newline, below the alphabet (bytes of 128 and up are negative
+// as signed chars, so they fail it as well) and DEL, the only byte above the alphabet that is left.
+// The bitmasks hold one bit per byte, bit i for byte i of the chunk.
+
+const char* line_scan_sse2(const char* data, const char* end, bool* valid, unsigned char* codes) {
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i below = _mm_set1_epi8(ALPHABET_FIRST - 1);
+    const __m128i above = _mm_set1_epi8(ALPHABET_LAST + 1);
+    const __m128i first = _mm_set1_epi8(ALPHABET_FIRST);
+
+    while (end - data >= 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)data);
+        uint32_t newlines = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline));
+        uint32_t invalid = ~(uint32_t)_mm_movemask_epi8(_mm_cmpgt_epi8(chunk, below)) & 0xffff;
+        invalid |= (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, above));
+        if (codes) {
+            _mm_storeu_si128((__m128i*)codes, _mm_sub_epi8(chunk, first));
+            codes += 16;
+        }
+
+        if (newlines) {
+            unsigned position = __builtin_ctz(newlines);
+            if (invalid & ((1u << position) - 1)) *valid = false;
+            return data + position;
+        }
+        if (invalid) *valid = false;
+        data += 16;
+    }
+    return line_scan_scalar(data, end, valid, codes);
+}
+
+__attribute__((target("avx2")))
+const char* line_scan_avx2(const char* data, const char* end, bool* valid, unsigned char* codes) {
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i below = _mm256_set1_epi8(ALPHABET_FIRST - 1);
+    const __m256i above = _mm256_set1_epi8(ALPHABET_LAST + 1);
+    const __m256i first = _mm256_set1_epi8(ALPHABET_FIRST);
+
+    while (end - data >= 32) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i*)data);
+        uint32_t newlines = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, newline));
+        uint32_t invalid = ~(uint32_t)_mm256_movemask_epi8(_mm256_cmpgt_epi8(chunk, below));
+        invalid |= (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, above));
+        if (codes) {
+            _mm256_storeu_si256((__m256i*)codes, _mm256_sub_epi8(chunk, first));
+            codes += 32;
+        }
+
+        if (newlines) {
+            unsigned position = __builtin_ctz(newlines);
+            if (invalid & (((uint64_t)1 << position) - 1)) *valid = false;
+            return data + position;
+        }
+        if (invalid) *valid = false;
+        data += 32;
+    }
+    return line_scan_sse2(data, end, valid, codes);
+}
+
+#endif
+
+typedef const char* (*LineScanFunction)(const char* data, const char* end, bool* valid, unsigned char* codes);
+
+const char* line_scan_resolve(const char* data, const char* end, bool* valid, unsigned char* codes);
+
+// Starts out as the resolver, which replaces itself with the implementation for this CPU on the first call
+_Atomic(LineScanFunction) line_scan_implementation = line_scan_resolve;
+
+const char* line_scan_resolve(const char* data, const char* end, bool* valid, unsigned char* codes) {
+#if defined(__x86_64__)
+    // SSE2 is part of x86-64 itself, AVX2 has to be asked for
+    LineScanFunction implementation = __builtin_cpu_supports("avx2") ? line_scan_avx2 : line_scan_sse2;
+#else
+    LineScanFunction implementation = line_scan_scalar;
+#endif
+    // Threads resolving at the same time all store the same function
+    atomic_store_explicit(&line_scan_implementation, implementation, memory_order_relaxed);
+    return implementation(data, end, valid, codes);
+}
+
+const char* line_scan(const char* data, const char* end, bool* valid, unsigned char* codes) {
+    return atomic_load_explicit(&line_scan_implementation, memory_order_relaxed)(data, end, valid, codes);
+}
@@ -0,0 +1,285 @@
+//
+// Log-structured merge tree: a sorted buffer in front of levelled, immutable sorted runs
+//
+
+#include "../include/lsmtree.h"
+#include "../include/utils.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LSM_BUFFER_CAPACITY 512     // Keys kept in the sorted buffer before it is flushed
+#define LSM_FANOUT 4                // Each level holds up to this many times the keys of the level above
+#define LSM_MAX_LEVELS 32
+#define LSM_BLOOM_BITS_PER_KEY 10
+#define LSM_BLOOM_HASHES 7          // About 1% false positives at 10 bits per key
+
+typedef struct LsmEntry {
+    uint64_t prefix;    // First 8 bytes of key, big-endian, see string_prefix
+    const char* key;    // Key bytes, stored once in the pool and shared by every run it moves through
+    uint32_t length;    // Length of key
+    uint32_t hash;      // lsmtree_hash of key
+} LsmEntry;
+
+// Immutable sorted run with its Bloom filter
+typedef struct LsmRun {
+    LsmEntry* entries;
+    size_t count;
+    uint64_t* bloom;    // Bloom filter bits, bloom_mask + 1 of them
+    size_t bloom_mask;
+} LsmRun;
+
+struct LsmTree {
+    LsmEntry buffer[LSM_BUFFER_CAPACITY];   // Newest keys in sorted order
+    size_t buffer_count;
+    LsmRun levels[LSM_MAX_LEVELS];          // At most one run per level, empty runs have count 0
+    size_t level_count;
+    size_t size;
+    NodePool* pool;                         // Owns the key bytes
+
+    size_t entries_written;                 // Statistics, see LsmStats
+    size_t lookups;
+    size_t runs_searched;
+    size_t bloom_skips;
+};
+
+LsmTree* lsmtree_init() {
+    LsmTree* tree = malloc(sizeof(LsmTree));
+    if (!tree) {
+        fprintf(stderr, "Memory allocation failed for LsmTree\n");
+        exit(EXIT_FAILURE);
+    }
+
+    tree->buffer_count = 0;
+    tree->level_count = 0;
+    tree->size = 0;
+    tree->pool = pool_init(1);
+    tree->entries_written = 0;
+    tree->lookups = 0;
+    tree->runs_searched = 0;
+    tree->bloom_skips = 0;
+    return tree;
+}
+
+void lsmtree_free_run(LsmRun* run) {
+    free(run->entries);
+    free(run->bloom);
+    run->entries = NULL;
+    run->bloom = NULL;
+    run->count = 0;
+}
+
+// Free the tree, the key bytes are released together with the pool
+void lsmtree_free(LsmTree* tree) {
+    if (!tree) return;
+
+    for (size_t i = 0; i < tree->level_count; i++) {
+        lsmtree_free_run(&tree->levels[i]);
+    }
+    pool_free(tree->pool);
+    free(tree);
+}
+
+// 64-bit FNV-1a with a final mix, truncated to the 32 bits an entry keeps next to its length
+uint32_t lsmtree_hash(const char* key, size_t length) {
+    uint64_t hash = 0xcbf29ce484222325;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ (unsigned char)key[i]) * 0x100000001b3;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccd;
+    hash ^= hash >> 33;
+    return (uint32_t)hash;
+}
+
+// Spread a stored hash over 64 bits, the two halves drive the Bloom filter probes.
+// Merges rebuild their filters from the stored hashes and never rehash the key bytes.
+uint64_t lsmtree_probe_hash(uint32_t hash) {
+    uint64_t spread = hash * 0x9e3779b97f4a7c15;
+    return spread ^ (spread >> 29);
+}
+
+// Probe i of a key looks at bit (h1 + i * h2) of the filter
+bool lsmtree_bloom_test(const LsmRun* run, uint64_t hash) {
+    uint64_t h2 = (hash >> 32) | 1;
+    for (size_t i = 0; i < LSM_BLOOM_HASHES; i++) {
+        uint64_t bit = (hash + i * h2) & run->bloom_mask;
+        if (!(run->bloom[bit / 64] & ((uint64_t)1 << (bit % 64)))) return false;
+    }
+    return true;
+}
+
+void lsmtree_bloom_set(LsmRun* run, uint64_t hash) {
+    uint64_t h2 = (hash >> 32) | 1;
+    for (size_t i = 0; i < LSM_BLOOM_HASHES; i++) {
+        uint64_t bit = (hash + i * h2) & run->bloom_mask;
+        run->bloom[bit / 64] |= (uint64_t)1 << (bit % 64);
+    }
+}
+
+// Binary search for key in a sorted array of entries. Returns whether it is present,
+// position receives the index of the first entry not smaller than key.
+bool lsmtree_find(const LsmEntry* entries, size_t count, const char* key, size_t length, uint64_t prefix,
+                  size_t* position) {
+    size_t low = 0, high = count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        size_t lcp;
+        int cmp = string_compare_prefixed(key, length, prefix, entries[middle].key, entries[middle].length,
+                                          entries[middle].prefix, 0, &lcp);
+        if (cmp == 0) {
+            *position = middle;
+            return true;
+        }
+        if (cmp < 0) high = middle;
+        else low = middle + 1;
+    }
+    *position = low;
+    return false;
+}
+
+// Look key up in the buffer and then in every run from new to old
+bool lsmtree_contains(LsmTree* tree, const LsmEntry* key, size_t* buffer_position) {
+    tree->lookups++;
+    if (lsmtree_find(tree->buffer, tree->buffer_count, key->key, key->length, key->prefix, buffer_position)) {
+        return true;
+    }
+
+    uint64_t hash = lsmtree_probe_hash(key->hash);
+    for (size_t i = 0; i < tree->level_count; i++) {
+        const LsmRun* run = &tree->levels[i];
+        if (run->count == 0) continue;
+
+        if (!lsmtree_bloom_test(run, hash)) {
+            tree->bloom_skips++;
+            continue;
+        }
+
+        size_t position;
+        tree->runs_searched++;
+        if (lsmtree_find(run->entries, run->count, key->key, key->length, key->prefix, &position)) return true;
+    }
+    return false;
+}
+
+// Merge two runs of distinct keys into a new run with a fresh Bloom filter
+LsmRun lsmtree_merge(LsmTree* tree, const LsmEntry* a, size_t a_count, const LsmEntry* b, size_t b_count) {
+    LsmRun run;
+    run.count = a_count + b_count;
+    run.entries = malloc(run.count * sizeof(LsmEntry));
+
+    size_t bits = 64;
+    while (bits < run.count * LSM_BLOOM_BITS_PER_KEY) bits *= 2;
+    run.bloom_mask = bits - 1;
+    run.bloom = calloc(bits / 64, sizeof(uint64_t));
+    if (!run.entries || !run.bloom) {
+        fprintf(stderr, "Memory allocation failed for LsmTree run\n");
+        exit(EXIT_FAILURE);
+    }
+
+    size_t i = 0, j = 0, k = 0;
+    while (i < a_count && j < b_count) {
+        size_t lcp;
+        if (string_compare_prefixed(a[i].key, a[i].length, a[i].prefix, b[j].key, b[j].length, b[j].prefix,
+                                    0, &lcp) < 0) {
+            run.entries[k++] = a[i++];
+        } else {
+            run.entries[k++] = b[j++];
+        }
+    }
+    while (i < a_count) run.entries[k++] = a[i++];
+    while (j < b_count) run.entries[k++] = b[j++];
+
+    for (k = 0; k < run.count; k++) {
+        lsmtree_bloom_set(&run, lsmtree_probe_hash(run.entries[k].hash));
+    }
+
+    tree->entries_written += run.count;
+    return run;
+}
+
+// Merge the full buffer into level 0, then push every level that outgrew its capacity one level down
+void lsmtree_flush(LsmTree* tree) {
+    if (tree->level_count == 0) {
+        tree->levels[0] = (LsmRun){ NULL, 0, NULL, 0 };
+        tree->level_count = 1;
+    }
+
+    LsmRun merged = lsmtree_merge(tree, tree->buffer, tree->buffer_count,
+                                  tree->levels[0].entries, tree->levels[0].count);
+    lsmtree_free_run(&tree->levels[0]);
+    tree->levels[0] = merged;
+    tree->buffer_count = 0;
+
+    size_t capacity = LSM_BUFFER_CAPACITY * LSM_FANOUT;
+    for (size_t i = 0; tree->levels[i].count > capacity; i++) {
+        if (i + 1 == LSM_MAX_LEVELS) {
+            fprintf(stderr, "Too many levels for LsmTree\n");
+            exit(EXIT_FAILURE);
+        }
+        if (i + 1 == tree->level_count) {
+            tree->levels[i + 1] = (LsmRun){ NULL, 0, NULL, 0 };
+            tree->level_count++;
+        }
+
+        merged = lsmtree_merge(tree, tree->levels[i].entries, tree->levels[i].count,
+                               tree->levels[i + 1].entries, tree->levels[i + 1].count);
+        lsmtree_free_run(&tree->levels[i]);
+        lsmtree_free_run(&tree->levels[i + 1]);
+        tree->levels[i + 1] = merged;
+        capacity *= LSM_FANOUT;
+    }
+}
+
+// Add a key, new keys go into the sorted buffer
+bool lsmtree_add(LsmTree* tree, const char* key) {
+    if (!tree || !key) return false;
+
+    size_t length = strlen(key);
+    LsmEntry entry = { string_prefix(key), key, length, lsmtree_hash(key, length) };
+    size_t position;
+    if (lsmtree_contains(tree, &entry, &position)) return false;
+
+    entry.key = pool_strndup(tree->pool, key, length);
+    memmove(&tree->buffer[position + 1], &tree->buffer[position],
+            (tree->buffer_count - position) * sizeof(LsmEntry));
+    tree->buffer[position] = entry;
+    tree->buffer_count++;
+    tree->size++;
+
+    if (tree->buffer_count == LSM_BUFFER_CAPACITY) lsmtree_flush(tree);
+    return true;
+}
+
+// Search for a key
+bool lsmtree_search(LsmTree* tree, const char* key) {
+    if (!tree || !key) return false;
+
+    size_t length = strlen(key);
+    LsmEntry entry = { string_prefix(key), key, length, lsmtree_hash(key, length) };
+    size_t position;
+    return lsmtree_contains(tree, &entry, &position);
+}
+
+// Return the number of keys in the tree
+size_t lsmtree_size(LsmTree* tree) {
+    return tree ? tree->size : 0;
+}
+
+void lsmtree_stats(const LsmTree* tree, LsmStats* stats) {
+    memset(stats, 0, sizeof(LsmStats));
+    if (!tree) return;
+
+    stats->keys = tree->size;
+    for (size_t i = 0; i < tree->level_count; i++) {
+        if (tree->levels[i].count > 0) stats->runs++;
+    }
+    stats->entries_written = tree->entries_written;
+    stats->write_amplification = tree->size ? (double)tree->entries_written / tree->size : 0;
+    stats->lookups = tree->lookups;
+    stats->runs_searched = tree->runs_searched;
+    stats->bloom_skips = tree->bloom_skips;
+    stats->runs_per_lookup = tree->lookups ? (double)tree->runs_searched / tree->lookups : 0;
+}
@@ -1,82 +1,158 @@
-#include "../include/cyclic.h"
-#include "../include//utils.h"
-#include "../include/struct_utils.h"
+#define _POSIX_C_SOURCE 200809L
 
+#include "../include/cycluniq.h"
+#include "../include/block_io.h"
+#include "../include/read_ahead.h"
+#include "../include/sharded_set.h"
+
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
-#define MAX_LINE_LENGTH 4096
-#define BATCH_SIZE 250 // 250 * 4097 = 1 024 250; < 1 048  576 = 1 MiB
+// Queue a new line on the writer of its lane, the emit callback of the engine.
+// Every block ends with a flush of the writers, so they only fill up in that flush and never
+// on a shard's worker. With --unordered every shard has a writer of its own.
+void write_line(const char* line, size_t length, size_t lane, void* context);
 
-// Function to handle command-line argument and select the appropriate data structure
-void process_line(void* structure, const char* datastructuur, char* line);
+// Parse a whole decimal number between min and max
+bool parse_number(const char* text, long min, long max, long* value);
 
 int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        fprintf(stderr, "Usage: %s <datastructuur>\n", argv[0]);
+    const char* reference_path = NULL;
+    long max_latency = -1;
+    long jobs = 1;
+    long shards = 1;
+    bool unordered = false;
+    bool io_uring = false;
+    int option = 1;
+    while (option < argc - 1) {
+        if (strcmp(argv[option], "--unordered") == 0) {
+            unordered = true;
+            option++;
+            continue;
+        }
+        if (strcmp(argv[option], "--io-uring") == 0) {
+            io_uring = true;
+            option++;
+            continue;
+        }
+        // Every other option takes a value, and the data structure still has to follow it
+        if (option + 2 >= argc) {
+            break;
+        }
+        const char* value = argv[option + 1];
+        if (strcmp(argv[option], "--reference") == 0) {
+            reference_path = value;
+        }
+        else if (strcmp(argv[option], "--max-latency") == 0) {
+            if (!parse_number(value, 0, INT_MAX, &max_latency)) break;
+        }
+        else if (strcmp(argv[option], "-j") == 0) {
+            if (!parse_number(value, 1, 1024, &jobs)) break;
+        }
+        else if (strcmp(argv[option], "--shards") == 0) {
+            if (!parse_number(value, 1, SHARDED_SET_MAX_SHARDS, &shards)) break;
+        }
+        else {
+            break;
+        }
+        option += 2;
+    }
+    if (option != argc - 1 || (unordered && shards == 1)) {
+        fprintf(stderr, "Usage: %s [--reference <file>] [--max-latency <ms>] [-j <threads>] [--shards <count> [--unordered]] "
+                        "[--io-uring] <datastructuur>\n", argv[0]);
         return 1;
     }
 
-    // Initialize the data structure based on command-line argument
-    const char* type = argv[1];
-    void* structure = init_datastructure(type);
-
-    if (structure == NULL) {
-        fprintf(stderr, "Failed to initialize the data structure\n");
+    // The dedup engine is the cycluniq library, this program only brings the input to it and the output away
+    const char* type = argv[argc - 1];
+    CycluniqOptions options = { reference_path, (size_t)jobs, (size_t)shards, unordered };
+    BlockWriter* writers[SHARDED_SET_MAX_SHARDS];
+    CycluniqError error;
+    Cycluniq* engine = cycluniq_init(type, &options, write_line, writers, &error);
+    if (engine == NULL) {
+        if (error == CYCLUNIQ_BAD_REFERENCE) {
+            fprintf(stderr, "Failed to read the reference file %s\n", reference_path);
+        }
+        else {
+            fprintf(stderr, "Failed to initialize the data structure\n");
+        }
         return 1;
     }
 
-    // Batch buffer to store lines
-    char* lines[BATCH_SIZE];
-    int line_count = 0;
-
-    // Buffer to store the input lines
-    char line[MAX_LINE_LENGTH + 1];
+    // Lines are processed straight from the input blocks and every block ends with one write.
+    // A redirected file is mapped instead of read, pipes and terminals go through the read buffer.
+    // With --io-uring, pipes are read and the output written through io_uring where the kernel has it.
+    BlockReader* input = block_reader_map(STDIN_FILENO);
+    bool plain_input = false;
+    if (input == NULL && io_uring) {
+        input = block_reader_ring(STDIN_FILENO);
+    }
+    if (input == NULL) {
+        input = block_reader_init(STDIN_FILENO);
+        plain_input = true;
+    }
+    // Slow producers get their answers within max_latency instead of once a whole block arrived
+    if (max_latency >= 0) {
+        block_reader_set_max_latency(input, (int)max_latency);
+    }
+    // The next block is read on its own thread while this one processes the current block.
+    // A mapping never waits for a read, and reads through io_uring are already in flight, they need no thread.
+    ReadAhead* ahead = plain_input ? read_ahead_init(input) : NULL;
+    // The shard writers of --unordered share the file position of the output, which writes
+    // through io_uring at positions of their own would not respect.
+    size_t lanes = unordered ? (size_t)shards : 1;
+    writers[0] = io_uring && !unordered ? block_writer_ring(STDOUT_FILENO) : NULL;
+    if (writers[0] == NULL) {
+        writers[0] = block_writer_init(STDOUT_FILENO);
+    }
+    for (size_t i = 1; i < lanes; i++) {
+        writers[i] = block_writer_init(STDOUT_FILENO);
+    }
 
-    // Read lines from stdin
-    while (fgets(line, sizeof(line), stdin))
+    LineSlice* lines;
+    size_t line_count;
+    while (ahead ? read_ahead_next(ahead, &lines, &line_count) : block_reader_next(input, &lines, &line_count))
     {
-        // Remove newline character
-        size_t len = strlen(line);
-        if (len > 0 && line[len - 1] == '\n') {
-            line[len - 1] = '\0';
-        }
-
-        // Store the line in the batch
-        lines[line_count++] = my_strdup(line);
-
-        if (line_count >= BATCH_SIZE)
-        {
-            for (int i = 0; i < BATCH_SIZE; i++)
-            {
-                process_line(structure, type, lines[i]);
-                free(lines[i]);
-            }
-            line_count = 0;
+        cycluniq_push_lines(engine, lines, line_count);
+        for (size_t i = 0; i < lanes; i++) {
+            block_writer_flush(writers[i]);
         }
     }
-
-    // process the last remaining lines
-    for (int i = 0; i < line_count; i++)
-    {
-        process_line(structure, type, lines[i]);
-        free(lines[i]);
+    cycluniq_finish(engine);
+    if (ahead) {
+        read_ahead_free(ahead);
+    }
+    else {
+        block_reader_free(input);
+    }
+    for (size_t i = 0; i < lanes; i++) {
+        block_writer_free(writers[i]);
     }
 
-    free_datastructure(structure, type);
+    // Such lines are still processed byte for byte, but the input breaks the spec
+    size_t invalid_count = cycluniq_invalid_lines(engine);
+    if (invalid_count > 0) {
+        fprintf(stderr, "Warning: %zu lines contain characters outside '?' to '~'\n", invalid_count);
+    }
 
+    cycluniq_free(engine);
     return 0;
 }
 
-void process_line(void* structure, const char* datastructuur, char* line) {
-    char* minimal_rotation = lexicographically_minimal_string_rotation(line);
+void write_line(const char* line, size_t length, size_t lane, void* context) {
+    BlockWriter** writers = context;
+    block_writer_append(writers[lane], line, length);
+}
 
-    if (!search_in_datastructure(structure, minimal_rotation, datastructuur)) {
-        // Print the original line and add the rotation to the data structure
-        printf("%s\n", line);
-        add_to_datastructure(structure, minimal_rotation, datastructuur);
+bool parse_number(const char* text, long min, long max, long* value) {
+    char* end;
+    long number = strtol(text, &end, 10);
+    if (*text == '\0' || *end != '\0' || number < min || number > max) {
+        return false;
     }
-
-    free(minimal_rotation);
-}
\ No newline at end of file
+    *value = number;
+    return true;
+}
@@ -0,0 +1,181 @@
+//
+// Reader thread that stays one block ahead of the thread processing the lines
+//
+
+#define _DEFAULT_SOURCE  // syscall
+
+#include "../include/read_ahead.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// A block taken over from the reader, its buffer and slices are exchanged instead of copied
+typedef struct ReadAheadSlot {
+    char* buffer;           // IO_BLOCK_SIZE bytes plus a terminator, owned by the slot between exchanges
+    LineSlice* lines;       // Slices into buffer
+    size_t count;
+    size_t line_capacity;
+    bool end;               // The input ended, no lines
+} ReadAheadSlot;
+
+// Lock-free single-producer single-consumer ring: only the reader thread moves head and only the consumer
+// moves tail, and the slots between them belong to the consumer. A side only goes to sleep when the ring is
+// empty or full, announcing it in its sleeping flag so the other side knows to wake it.
+struct ReadAhead {
+    BlockReader* reader;
+    pthread_t thread;
+    ReadAheadSlot slots[READ_AHEAD_SLOTS];
+    bool holding;                       // The consumer still uses the slot at tail
+    bool finished;                      // The consumer has seen the end of the input
+    atomic_bool stop;
+    _Alignas(64) atomic_uint head;      // Slots filled so far, on a cache line of its own
+    atomic_bool consumer_sleeping;
+    _Alignas(64) atomic_uint tail;      // Slots handed back so far
+    atomic_bool reader_sleeping;
+};
+
+#ifdef __linux__
+
+// Sleep until woken, unless *word no longer holds value
+static void read_ahead_sleep(atomic_uint* word, unsigned int value) {
+    syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+}
+
+static void read_ahead_wake(atomic_uint* word) {
+    syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+#else
+
+static void read_ahead_sleep(atomic_uint* word, unsigned int value) {
+    (void)word;
+    (void)value;
+    sched_yield();
+}
+
+static void read_ahead_wake(atomic_uint* word) {
+    (void)word;
+}
+
+#endif
+
+// Wait until the other side moves *word away from value. The flag is raised before the last look at *word
+// and the other side looks at the flag after moving *word, both sequentially consistent, so no wake is lost.
+void read_ahead_wait(atomic_uint* word, unsigned int value, atomic_bool* sleeping) {
+    while (atomic_load_explicit(word, memory_order_acquire) == value) {
+        atomic_store(sleeping, true);
+        if (atomic_load(word) == value) read_ahead_sleep(word, value);
+        atomic_store(sleeping, false);
+    }
+}
+
+// Move *word on by one, waking the other side if it sleeps on it
+void read_ahead_advance(atomic_uint* word, atomic_bool* sleeping) {
+    atomic_fetch_add(word, 1);
+    if (atomic_load(sleeping)) read_ahead_wake(word);
+}
+
+void* read_ahead_run(void* argument) {
+    ReadAhead* ahead = argument;
+    for (;;) {
+        // Wait for a free slot
+        unsigned int head = atomic_load_explicit(&ahead->head, memory_order_relaxed);
+        unsigned int tail = atomic_load_explicit(&ahead->tail, memory_order_acquire);
+        if (head - tail == READ_AHEAD_SLOTS) read_ahead_wait(&ahead->tail, tail, &ahead->reader_sleeping);
+        if (atomic_load(&ahead->stop)) break;
+
+        ReadAheadSlot* slot = &ahead->slots[head % READ_AHEAD_SLOTS];
+        LineSlice* lines;
+        slot->end = !block_reader_next(ahead->reader, &lines, &slot->count);
+        if (!slot->end) block_reader_exchange(ahead->reader, &slot->buffer, &slot->lines, &slot->line_capacity);
+
+        read_ahead_advance(&ahead->head, &ahead->consumer_sleeping);
+        if (slot->end) break;
+    }
+    return NULL;
+}
+
+ReadAhead* read_ahead_init(BlockReader* reader) {
+    ReadAhead* ahead = aligned_alloc(_Alignof(ReadAhead), sizeof(ReadAhead));
+    if (!ahead) {
+        fprintf(stderr, "Memory allocation failed for ReadAhead\n");
+        exit(EXIT_FAILURE);
+    }
+
+    ahead->reader = reader;
+    for (size_t i = 0; i < READ_AHEAD_SLOTS; i++) {
+        ReadAheadSlot* slot = &ahead->slots[i];
+        slot->buffer = malloc(IO_BLOCK_SIZE + 1);
+        slot->line_capacity = 1024;
+        slot->lines = malloc(slot->line_capacity * sizeof(LineSlice));
+        slot->count = 0;
+        slot->end = false;
+        if (!slot->buffer || !slot->lines) {
+            fprintf(stderr, "Memory allocation failed for ReadAhead\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    ahead->holding = false;
+    ahead->finished = false;
+    atomic_init(&ahead->stop, false);
+    atomic_init(&ahead->head, 0);
+    atomic_init(&ahead->consumer_sleeping, false);
+    atomic_init(&ahead->tail, 0);
+    atomic_init(&ahead->reader_sleeping, false);
+
+    if (pthread_create(&ahead->thread, NULL, read_ahead_run, ahead) != 0) {
+        fprintf(stderr, "Failed to start the reader thread\n");
+        exit(EXIT_FAILURE);
+    }
+    return ahead;
+}
+
+bool read_ahead_next(ReadAhead* ahead, LineSlice** lines, size_t* count) {
+    *count = 0;
+    if (ahead->finished) return false;
+
+    // Hand the previous block back to the reader thread
+    if (ahead->holding) {
+        ahead->holding = false;
+        read_ahead_advance(&ahead->tail, &ahead->reader_sleeping);
+    }
+
+    unsigned int tail = atomic_load_explicit(&ahead->tail, memory_order_relaxed);
+    read_ahead_wait(&ahead->head, tail, &ahead->consumer_sleeping);
+    ReadAheadSlot* slot = &ahead->slots[tail % READ_AHEAD_SLOTS];
+    ahead->holding = true;
+    if (slot->end) {
+        ahead->finished = true;
+        return false;
+    }
+
+    *lines = slot->lines;
+    *count = slot->count;
+    return true;
+}
+
+void read_ahead_free(ReadAhead* ahead) {
+    if (!ahead) return;
+
+    // Wake the reader thread if it waits for a free slot, it stops before reading again.
+    // Moving tail on, as if a slot came back, is what ends its wait.
+    atomic_store(&ahead->stop, true);
+    read_ahead_advance(&ahead->tail, &ahead->reader_sleeping);
+    pthread_join(ahead->thread, NULL);
+
+    for (size_t i = 0; i < READ_AHEAD_SLOTS; i++) {
+        free(ahead->slots[i].buffer);
+        free(ahead->slots[i].lines);
+    }
+    block_reader_free(ahead->reader);
+    free(ahead);
+}
@@ -5,6 +5,7 @@
 #include "../include/searchtree.h"
 #include "../include/utils.h"
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -14,14 +15,24 @@ typedef enum { RED, BLACK } Color;
 typedef struct Node {
     char* key;
     Color color;
+    uint32_t length;        // Length of key, fills the padding after color
     struct Node* left;
     struct Node* right;
     struct Node* parent;
+    uint64_t prefix;        // First 8 bytes of key, big-endian, see string_prefix
 } Node;
 
+// Key being searched for or added, prepared once per descent
+typedef struct SearchKey {
+    const char* key;
+    size_t length;
+    uint64_t prefix;
+} SearchKey;
+
 struct SearchTree {
     Node* root;
     size_t size;
+    NodePool* pool;  // Owns every node and key of the tree
 };
 
 // Function to check if a node is red
@@ -30,9 +41,11 @@ bool is_red(Node* node) {
 }
 
 // Helper function to create a new node with is_red initialized
-Node* searchtree_create_node(const char* key, Color color, Node* parent) {
-    Node* node = malloc(sizeof(Node));
-    node->key = my_strdup(key);  // Duplicate the key
+Node* searchtree_create_node(SearchTree* tree, const SearchKey* key, Color color, Node* parent) {
+    Node* node = pool_alloc(tree->pool);
+    node->key = pool_strndup(tree->pool, key->key, key->length);  // Duplicate the key
+    node->length = key->length;
+    node->prefix = key->prefix;
     node->color = color;
     node->left = NULL;
     node->right = NULL;
@@ -50,23 +63,14 @@ SearchTree* searchtree_init() {
 
     tree->root = NULL;
     tree->size = 0;
+    tree->pool = pool_init(sizeof(Node));
     return tree;
 }
 
-// Helper function to free nodes
-void free_node(Node* node) {
-    if (node) {
-        free(node->key);
-        free_node(node->left);
-        free_node(node->right);
-        free(node);
-    }
-}
-
-// Function to free the entire search tree
+// Function to free the entire search tree, all nodes are released together with the pool
 void searchtree_free(SearchTree* tree) {
     if (tree) {
-        free_node(tree->root);
+        pool_free(tree->pool);
         free(tree);
     }
 }
@@ -152,47 +156,352 @@ void insert_fixup(SearchTree* tree, Node* z) {
     tree->root->color = BLACK;  // Ensure the root is always black
 }
 
-// Add a node to the Red-Black Tree
-bool searchtree_add(SearchTree* tree, const char* key) {
-    if (!tree || !key) return false;
+// Compare key with a node whose first offset characters are known to be equal,
+// lcp receives the length of their common prefix.
+// The inline prefix settles most comparisons inside the node, the key strings are only read on a prefix tie.
+int searchtree_compare_node(const SearchKey* key, const Node* node, size_t offset, size_t* lcp) {
+    return string_compare_prefixed(key->key, key->length, key->prefix,
+                                   node->key, node->length, node->prefix, offset, lcp);
+}
+
+// During a descent every node of the current subtree lies between the last node we went right
+// at (lower bound) and the last node we went left at (upper bound). The key shares lower_lcp
+// characters with the first and upper_lcp with the second, so it shares at least their minimum
+// with every node below and each comparison can skip that many characters.
 
+// Descend from start to the place of key and link a new node there, unless the key is met on the way.
+// finger receives the node holding key either way.
+bool searchtree_add_from(SearchTree* tree, Node* start, const SearchKey* key, Node** finger) {
     Node* y = NULL;
-    Node* x = tree->root;
+    Node* x = start;
+    int cmp = 0;
+    size_t lower_lcp = 0, upper_lcp = 0;
 
     // Check if key already exists in the tree
     while (x) {
         y = x;
-        int cmp = strcmp(key, x->key);
-        if (cmp == 0) return false;  // Key already exists
-        x = (cmp < 0) ? x->left : x->right;
+        size_t lcp;
+        cmp = searchtree_compare_node(key, x, lower_lcp < upper_lcp ? lower_lcp : upper_lcp, &lcp);
+        if (cmp == 0) {  // Key already exists
+            *finger = x;
+            return false;
+        }
+        if (cmp < 0) {
+            upper_lcp = lcp;
+            x = x->left;
+        } else {
+            lower_lcp = lcp;
+            x = x->right;
+        }
     }
 
     // Create the new node
-    Node* z = searchtree_create_node(key, RED, y);
+    Node* z = searchtree_create_node(tree, key, RED, y);
     if (!y) tree->root = z;  // Tree was empty
-    else if (strcmp(key, y->key) < 0) y->left = z;
+    else if (cmp < 0) y->left = z;
     else y->right = z;
 
     tree->size++;
     insert_fixup(tree, z);  // Fix Red-Black properties after insertion
+    *finger = z;
     return true;
 }
 
+// Add a node to the Red-Black Tree
+bool searchtree_add(SearchTree* tree, const char* key) {
+    if (!tree || !key) return false;
+
+    SearchKey search_key = { key, strlen(key), string_prefix(key) };
+    Node* finger;
+    return searchtree_add_from(tree, tree->root, &search_key, &finger);
+}
+
+// Batch entry with the position of the key in the caller's array
+typedef struct SearchTreeBatchKey {
+    const char* key;
+    size_t index;
+} SearchTreeBatchKey;
+
+int searchtree_compare_batch_keys(const void* a, const void* b) {
+    const SearchTreeBatchKey* x = a;
+    const SearchTreeBatchKey* y = b;
+    int cmp = strcmp(x->key, y->key);
+    if (cmp != 0) return cmp;
+    return (x->index > y->index) - (x->index < y->index);  // Equal keys keep input order
+}
+
+// Find the smallest subtree around finger that holds the place of a key not smaller than the finger's.
+// Going up from a right child never passes the key; going up from a left child only does
+// when the key sorts after the parent, so only those parents need a comparison.
+Node* searchtree_climb(Node* finger, const SearchKey* key) {
+    Node* x = finger;
+    while (x->parent) {
+        Node* parent = x->parent;
+        if (x == parent->left) {
+            size_t lcp;
+            int cmp = searchtree_compare_node(key, parent, 0, &lcp);
+            if (cmp < 0) return x;
+            if (cmp == 0) return parent;
+        }
+        x = parent;
+    }
+    return x;
+}
+
+// Add a batch of keys in sorted order. Every key after the first starts from the node of the
+// previous key (the finger) and only climbs as far as needed before descending, so keys that lie
+// close together share most of their path instead of each walking down from the root.
+// added[i] tells whether keys[i] was new, as if the keys were added in input order; NULL keys are skipped.
+void searchtree_insert_batch(SearchTree* tree, const char** keys, size_t count, bool* added) {
+    if (!tree || count == 0) return;
+
+    SearchTreeBatchKey* batch = malloc(count * sizeof(SearchTreeBatchKey));
+    if (!batch) {
+        fprintf(stderr, "Memory allocation failed for search tree batch\n");
+        exit(EXIT_FAILURE);
+    }
+
+    size_t batch_length = 0;
+    for (size_t i = 0; i < count; i++) {
+        added[i] = false;
+        if (keys[i]) {
+            batch[batch_length++] = (SearchTreeBatchKey){ keys[i], i };
+        }
+    }
+    qsort(batch, batch_length, sizeof(SearchTreeBatchKey), searchtree_compare_batch_keys);
+
+    Node* finger = NULL;
+    const char* previous = NULL;
+    for (size_t i = 0; i < batch_length; i++) {
+        const char* key = batch[i].key;
+        if (previous && strcmp(key, previous) == 0) continue;  // Duplicate within the batch
+        previous = key;
+
+        SearchKey search_key = { key, strlen(key), string_prefix(key) };
+        Node* start = finger ? searchtree_climb(finger, &search_key) : tree->root;
+        added[batch[i].index] = searchtree_add_from(tree, start, &search_key, &finger);
+    }
+
+    free(batch);
+}
+
 // Search for a key in the Red-Black Tree
 bool searchtree_search(const SearchTree* tree, const char* key) {
     if (!tree || !key) return false;
 
+    SearchKey search_key = { key, strlen(key), string_prefix(key) };
     Node* x = tree->root;
+    size_t lower_lcp = 0, upper_lcp = 0;
     while (x) {
-        int cmp = strcmp(key, x->key);
+        size_t lcp;
+        int cmp = searchtree_compare_node(&search_key, x, lower_lcp < upper_lcp ? lower_lcp : upper_lcp, &lcp);
         if (cmp == 0) return true;
-        x = (cmp < 0) ? x->left : x->right;
+        if (cmp < 0) {
+            upper_lcp = lcp;
+            x = x->left;
+        } else {
+            lower_lcp = lcp;
+            x = x->right;
+        }
     }
     return false;
 }
 
+size_t searchtree_depth(const SearchTree* tree, const char* key) {
+    if (!tree || !key) return 0;
+
+    size_t depth = 0;
+    Node* x = tree->root;
+    while (x) {
+        depth++;
+        int cmp = strcmp(key, x->key);
+        if (cmp == 0) break;
+        x = cmp < 0 ? x->left : x->right;
+    }
+    return depth;
+}
+
 // Return the size of the Red-Black Tree
 size_t searchtree_size(SearchTree* tree) {
     return tree ? tree->size : 0;
 }
 
+
+// Immutable copy of a search tree, laid out as a perfectly balanced tree in van Emde Boas order:
+// a tree of height h is stored as its top half (height h / 2) followed by every bottom half, each
+// laid out the same way recursively. Whatever the cache line size, a root-to-leaf path then
+// touches O(log_B n) lines. Children are found by arithmetic on the breadth-first index instead of
+// pointers: a node at depth d with breadth-first index i lies at
+//     pos[d] = pos[top_depth[d]] + top_size[d] + (i & top_size[d]) * bottom_size[d]
+// where top_depth[d] is the depth of the root of the enclosing top half, pos[] holds the
+// positions along the current path and top_size / bottom_size are the sizes of the halves.
+typedef struct FrozenSlot {
+    uint64_t prefix;    // First 8 bytes of the key, big-endian, see string_prefix
+    uint32_t offset;    // Start of the key in the key array
+    uint32_t length;    // Length of the key, FROZEN_EMPTY for a slot past the last key
+} FrozenSlot;
+
+#define FROZEN_EMPTY UINT32_MAX
+#define FROZEN_MAX_HEIGHT 40
+
+struct FrozenSearchTree {
+    FrozenSlot* slots;                          // 2^height - 1 slots in van Emde Boas order
+    char* keys;                                 // Null-terminated keys in sorted order
+    size_t height;                              // Height of the perfect tree holding the keys
+    size_t size;                                // Number of keys
+    size_t top_depth[FROZEN_MAX_HEIGHT];        // Per depth, see above
+    size_t top_size[FROZEN_MAX_HEIGHT];
+    size_t bottom_size[FROZEN_MAX_HEIGHT];
+};
+
+// Fill the per-depth tables for a (sub)tree of the given height whose root sits at depth.
+// The layout only depends on depths, so one pass over the recursion covers every subtree.
+void frozen_searchtree_tables(FrozenSearchTree* frozen, size_t depth, size_t height) {
+    if (height <= 1) return;
+
+    size_t top_height = height / 2;
+    size_t bottom_height = height - top_height;
+    frozen->top_depth[depth + top_height] = depth;
+    frozen->top_size[depth + top_height] = ((size_t)1 << top_height) - 1;
+    frozen->bottom_size[depth + top_height] = ((size_t)1 << bottom_height) - 1;
+
+    frozen_searchtree_tables(frozen, depth, top_height);
+    frozen_searchtree_tables(frozen, depth + top_height, bottom_height);
+}
+
+// Store the keys of rank [low, high) of sorted as the balanced subtree at breadth-first index bfs,
+// path holds the van Emde Boas positions of its ancestors by depth
+void frozen_searchtree_place(FrozenSearchTree* frozen, Node** sorted, const uint32_t* offsets, size_t low, size_t high,
+                             size_t bfs, size_t depth, size_t* path) {
+    if (depth == frozen->height) return;
+
+    if (depth > 0) {
+        size_t top = frozen->top_size[depth];
+        path[depth] = path[frozen->top_depth[depth]] + top + (bfs & top) * frozen->bottom_size[depth];
+    }
+
+    FrozenSlot* slot = &frozen->slots[path[depth]];
+    if (low == high) {
+        slot->length = FROZEN_EMPTY;
+        slot->prefix = 0;
+        slot->offset = 0;
+        // Descendants of an empty slot are never visited, but are cleared for a deterministic layout
+        frozen_searchtree_place(frozen, sorted, offsets, low, low, 2 * bfs, depth + 1, path);
+        frozen_searchtree_place(frozen, sorted, offsets, low, low, 2 * bfs + 1, depth + 1, path);
+        return;
+    }
+
+    size_t middle = low + (high - low) / 2;
+    slot->prefix = sorted[middle]->prefix;
+    slot->offset = offsets[middle];
+    slot->length = sorted[middle]->length;
+    frozen_searchtree_place(frozen, sorted, offsets, low, middle, 2 * bfs, depth + 1, path);
+    frozen_searchtree_place(frozen, sorted, offsets, middle + 1, high, 2 * bfs + 1, depth + 1, path);
+}
+
+// Rebuild the tree as a frozen van Emde Boas array in O(n): an in-order walk along the parent
+// links lists the keys in sorted order, after which every slot is written exactly once
+FrozenSearchTree* searchtree_freeze(const SearchTree* tree) {
+    if (!tree) return NULL;
+
+    FrozenSearchTree* frozen = malloc(sizeof(FrozenSearchTree));
+    Node** sorted = malloc((tree->size ? tree->size : 1) * sizeof(Node*));
+    uint32_t* offsets = malloc((tree->size ? tree->size : 1) * sizeof(uint32_t));
+    if (!frozen || !sorted || !offsets) {
+        fprintf(stderr, "Memory allocation failed for FrozenSearchTree\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // In-order walk without a stack
+    size_t count = 0, key_bytes = 0;
+    Node* x = tree->root;
+    while (x && x->left) x = x->left;
+    while (x) {
+        key_bytes += x->length + 1;
+        sorted[count++] = x;
+        if (x->right) {
+            x = x->right;
+            while (x->left) x = x->left;
+        } else {
+            while (x->parent && x == x->parent->right) x = x->parent;
+            x = x->parent;
+        }
+    }
+    if (key_bytes > UINT32_MAX) {
+        fprintf(stderr, "Too many key bytes for FrozenSearchTree\n");
+        exit(EXIT_FAILURE);
+    }
+
+    frozen->size = count;
+    frozen->height = 0;
+    while (((size_t)1 << frozen->height) - 1 < count) frozen->height++;
+    frozen->slots = malloc(((size_t)1 << frozen->height) * sizeof(FrozenSlot));  // One spare, never empty
+    frozen->keys = malloc(key_bytes + 1);
+    if (!frozen->slots || !frozen->keys) {
+        fprintf(stderr, "Memory allocation failed for FrozenSearchTree\n");
+        exit(EXIT_FAILURE);
+    }
+
+    size_t offset = 0;
+    for (size_t i = 0; i < count; i++) {
+        offsets[i] = offset;
+        memcpy(frozen->keys + offset, sorted[i]->key, sorted[i]->length + 1);
+        offset += sorted[i]->length + 1;
+    }
+
+    frozen_searchtree_tables(frozen, 0, frozen->height);
+    size_t path[FROZEN_MAX_HEIGHT];
+    path[0] = 0;
+    frozen_searchtree_place(frozen, sorted, offsets, 0, count, 1, 0, path);
+
+    free(sorted);
+    free(offsets);
+    return frozen;
+}
+
+// Search for a key in the frozen tree, skipping the characters shared with both bounds as in searchtree_search
+bool frozen_searchtree_search(const FrozenSearchTree* frozen, const char* key) {
+    if (!frozen || !key) return false;
+
+    SearchKey search_key = { key, strlen(key), string_prefix(key) };
+    size_t path[FROZEN_MAX_HEIGHT];
+    size_t bfs = 1;
+    size_t lower_lcp = 0, upper_lcp = 0;
+    path[0] = 0;
+    for (size_t depth = 0; depth < frozen->height; ) {
+        const FrozenSlot* slot = &frozen->slots[path[depth]];
+        if (slot->length == FROZEN_EMPTY) return false;
+
+        size_t lcp;
+        int cmp = string_compare_prefixed(search_key.key, search_key.length, search_key.prefix,
+                                          frozen->keys + slot->offset, slot->length, slot->prefix,
+                                          lower_lcp < upper_lcp ? lower_lcp : upper_lcp, &lcp);
+        if (cmp == 0) return true;
+        if (cmp < 0) {
+            upper_lcp = lcp;
+            bfs = 2 * bfs;
+        } else {
+            lower_lcp = lcp;
+            bfs = 2 * bfs + 1;
+        }
+
+        if (++depth == frozen->height) break;
+        size_t top = frozen->top_size[depth];
+        path[depth] = path[frozen->top_depth[depth]] + top + (bfs & top) * frozen->bottom_size[depth];
+    }
+    return false;
+}
+
+// Get the number of keys in the frozen tree
+size_t frozen_searchtree_size(const FrozenSearchTree* frozen) {
+    return frozen ? frozen->size : 0;
+}
+
+// Free the frozen tree
+void frozen_searchtree_free(FrozenSearchTree* frozen) {
+    if (!frozen) return;
+
+    free(frozen->slots);
+    free(frozen->keys);
+    free(frozen);
+}
@@ -0,0 +1,179 @@
+//
+// Canonical key set split by hash over data structures that are each owned by one thread
+//
+
+#include "../include/sharded_set.h"
+#include "../include/struct_utils.h"
+#include "../include/utils.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SHARDED_SET_BATCH 250   // Keys handed to a shard's structure at once, as main.c does for a single structure
+
+struct ShardedSet {
+    char* type;                 // Own copy, the shard workers keep using it after sharded_set_init returns
+    size_t shard_count;
+    void** structures;          // One data structure per shard, created by its worker on the shard's first key
+    size_t* sizes;              // Keys per shard, only written by the shard's worker
+
+    // The batch being added
+    size_t* starts;             // Keys of shard s are order[starts[s]] up to order[starts[s + 1]]
+    size_t* order;              // Key indices grouped by shard, in input order within each shard
+    size_t order_capacity;
+    char** keys;
+    const unsigned int* hashes;
+    bool* added;
+    void (*emit)(size_t index, size_t shard, void* context);
+    void* context;
+};
+
+ShardedSet* sharded_set_init(const char* type, size_t shards) {
+    if (shards == 0 || shards > SHARDED_SET_MAX_SHARDS) return NULL;
+
+    ShardedSet* set = malloc(sizeof(ShardedSet));
+    if (!set) {
+        fprintf(stderr, "Memory allocation failed for ShardedSet\n");
+        exit(EXIT_FAILURE);
+    }
+    set->type = my_strdup(type);
+    set->shard_count = shards;
+    set->structures = malloc(shards * sizeof(void*));
+    set->sizes = calloc(shards, sizeof(size_t));
+    set->starts = malloc((shards + 1) * sizeof(size_t));
+    set->order = NULL;
+    set->order_capacity = 0;
+    if (!set->type || !set->structures || !set->sizes || !set->starts) {
+        fprintf(stderr, "Memory allocation failed for ShardedSet\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Only the first shard exists up front, which also checks the type. With every shard created here,
+    // the initial reservations of many shards would add up far beyond what one structure may reserve.
+    set->structures[0] = init_datastructure(type);
+    if (!set->structures[0]) {
+        free(set->structures);
+        free(set->sizes);
+        free(set->starts);
+        free(set->type);
+        free(set);
+        return NULL;
+    }
+    for (size_t i = 1; i < shards; i++) {
+        set->structures[i] = NULL;
+    }
+    return set;
+}
+
+size_t sharded_set_shards(const ShardedSet* set) {
+    return set->shard_count;
+}
+
+// 32-bit FNV-1a with a final mix. The hashtable shards use djb2 modulo a power of two,
+// so the shard has to come from other bits or every shard would fill only a fraction of its buckets.
+unsigned int sharded_set_shard(const ShardedSet* set, const char* key) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char* c = (const unsigned char*)key; *c; c++) {
+        hash = (hash ^ *c) * 16777619u;
+    }
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    return (unsigned int)(((uint64_t)hash * set->shard_count) >> 32);
+}
+
+// Insert the keys of one shard in input order, runs on the worker that owns the shard
+void sharded_set_add_shard(size_t worker, void* context) {
+    ShardedSet* set = context;
+    if (worker >= set->shard_count || set->starts[worker] == set->starts[worker + 1]) return;
+    if (!set->structures[worker]) {
+        set->structures[worker] = init_datastructure(set->type);
+    }
+
+    const char* keys[SHARDED_SET_BATCH];
+    unsigned int hashes[SHARDED_SET_BATCH];
+    bool added[SHARDED_SET_BATCH];
+    size_t end = set->starts[worker + 1];
+    for (size_t begin = set->starts[worker]; begin < end; begin += SHARDED_SET_BATCH) {
+        size_t count = end - begin < SHARDED_SET_BATCH ? end - begin : SHARDED_SET_BATCH;
+        for (size_t i = 0; i < count; i++) {
+            size_t index = set->order[begin + i];
+            keys[i] = set->keys[index];
+            hashes[i] = set->hashes ? set->hashes[index] : 0;
+        }
+        add_canonical_batch_to_datastructure(set->structures[worker], keys, set->hashes ? hashes : NULL, count,
+                                             set->type, added);
+
+        for (size_t i = 0; i < count; i++) {
+            size_t index = set->order[begin + i];
+            set->added[index] = added[i];
+            if (added[i]) {
+                set->sizes[worker]++;
+                if (set->emit) set->emit(index, worker, set->context);
+            }
+            free(set->keys[index]);
+        }
+    }
+}
+
+void sharded_set_add_batch(ShardedSet* set, ThreadPool* pool, char** keys, const unsigned int* hashes,
+                           const unsigned int* shard_of, size_t count, bool* added,
+                           void (*emit)(size_t index, size_t shard, void* context), void* context) {
+    if (thread_pool_workers(pool) < set->shard_count) {
+        fprintf(stderr, "ShardedSet needs a worker per shard\n");
+        exit(EXIT_FAILURE);
+    }
+    if (count > set->order_capacity) {
+        set->order_capacity = count;
+        set->order = realloc(set->order, set->order_capacity * sizeof(size_t));
+        if (!set->order) {
+            fprintf(stderr, "Memory allocation failed for ShardedSet order\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Counting sort of the key indices on their shard, which keeps input order within a shard
+    memset(set->starts, 0, (set->shard_count + 1) * sizeof(size_t));
+    for (size_t i = 0; i < count; i++) {
+        added[i] = false;
+        if (keys[i]) set->starts[shard_of[i] + 1]++;
+    }
+    for (size_t s = 0; s < set->shard_count; s++) {
+        set->starts[s + 1] += set->starts[s];
+    }
+    size_t next[SHARDED_SET_MAX_SHARDS];
+    memcpy(next, set->starts, set->shard_count * sizeof(size_t));
+    for (size_t i = 0; i < count; i++) {
+        if (keys[i]) set->order[next[shard_of[i]]++] = i;
+    }
+
+    set->keys = keys;
+    set->hashes = hashes;
+    set->added = added;
+    set->emit = emit;
+    set->context = context;
+    thread_pool_run_each(pool, sharded_set_add_shard, set);
+}
+
+size_t sharded_set_size(const ShardedSet* set) {
+    size_t size = 0;
+    for (size_t i = 0; i < set->shard_count; i++) {
+        size += set->sizes[i];
+    }
+    return size;
+}
+
+void sharded_set_free(ShardedSet* set) {
+    if (!set) return;
+
+    for (size_t i = 0; i < set->shard_count; i++) {
+        if (set->structures[i]) free_datastructure(set->structures[i], set->type);
+    }
+    free(set->structures);
+    free(set->sizes);
+    free(set->starts);
+    free(set->order);
+    free(set->type);
+    free(set);
+}
@@ -0,0 +1,188 @@
+//
+// Lock-free skip list: every level is a sorted linked list and nodes are linked in by compare-and-swap
+//
+
+#include "../include/skiplist.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/utils.h"
+
+#define SKIPLIST_MAX_HEIGHT 24      // With a quarter of the nodes reaching each next level, enough for 4^24 keys
+
+// A node with its tower of forward links. Keys are never removed, so a link only ever
+// changes from a node to a new node inserted right after it.
+typedef struct SkipNode {
+    const char *key;                        // Key bytes, stored in the pool
+    uint64_t prefix;                        // First 8 bytes of key, big-endian, see string_prefix
+    uint32_t length;                        // Length of key
+    uint32_t height;                        // Number of levels the node is linked into
+    _Atomic(struct SkipNode *) next[];      // Successor per level
+} SkipNode;
+
+struct SkipList {
+    SkipNode *head;         // Sentinel before every key, as tall as the list can get
+    atomic_size_t size;     // Total number of keys
+    SharedPool *pool;       // Owns every node and key
+};
+
+static _Thread_local uint64_t skiplist_random_state;
+
+// Height of a new node: level i + 1 is reached with probability 1/4 from level i
+uint32_t skiplist_random_height() {
+    uint64_t x = skiplist_random_state;
+    if (x == 0) x = (uintptr_t)&skiplist_random_state | 1;  // Seed per thread from its own storage
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    skiplist_random_state = x;
+
+    uint32_t height = 1;
+    while (height < SKIPLIST_MAX_HEIGHT && (x & 3) == 0) {
+        height++;
+        x >>= 2;
+    }
+    return height;
+}
+
+SkipNode *skiplist_create_node(SkipList *list, uint32_t height) {
+    SkipNode *node = shared_pool_alloc(list->pool, sizeof(SkipNode) + height * sizeof(_Atomic(SkipNode *)));
+    node->height = height;
+    for (uint32_t i = 0; i < height; i++) {
+        atomic_init(&node->next[i], NULL);
+    }
+    return node;
+}
+
+// Initialize a new skip list
+SkipList *skiplist_init() {
+    SkipList *list = malloc(sizeof(SkipList));
+    if (!list) {
+        fprintf(stderr, "Memory allocation failed for SkipList\n");
+        exit(EXIT_FAILURE);
+    }
+
+    list->pool = shared_pool_init();
+    list->head = skiplist_create_node(list, SKIPLIST_MAX_HEIGHT);
+    list->head->key = NULL;
+    atomic_init(&list->size, 0);
+    return list;
+}
+
+// Compare key with the key of node
+int skiplist_compare(const char *key, size_t length, uint64_t prefix, const SkipNode *node) {
+    size_t lcp;
+    return string_compare_prefixed(key, length, prefix, node->key, node->length, node->prefix, 0, &lcp);
+}
+
+// Find on every level the last node before key (preds) and the node after it (succs), unless preds is NULL.
+// Returns the node holding key, if any. Descending reuses the predecessor of the level above.
+SkipNode *skiplist_find(const SkipList *list, const char *key, size_t length, uint64_t prefix,
+                        SkipNode **preds, SkipNode **succs) {
+    SkipNode *pred = list->head;
+    SkipNode *found = NULL;
+    for (int level = SKIPLIST_MAX_HEIGHT - 1; level >= 0; level--) {
+        SkipNode *curr = atomic_load_explicit(&pred->next[level], memory_order_acquire);
+        while (curr) {
+            int cmp = curr == found ? 0 : skiplist_compare(key, length, prefix, curr);
+            if (cmp <= 0) {
+                if (cmp == 0) {
+                    if (!preds) return curr;  // A plain search needs no predecessors
+                    found = curr;
+                }
+                break;
+            }
+            pred = curr;
+            curr = atomic_load_explicit(&pred->next[level], memory_order_acquire);
+        }
+        if (preds) {
+            preds[level] = pred;
+            succs[level] = curr;
+        }
+    }
+    return found;
+}
+
+// Add a key if it is absent, safe to call from several threads at once.
+// The node becomes part of the set when it is linked into level 0 by a single compare-and-swap,
+// so concurrent adds of the same key agree on exactly one winner. The upper levels are only
+// shortcuts and are linked in afterwards, retrying a level whenever a neighbour changed.
+bool skiplist_add(SkipList *list, const char *key) {
+    if (!list || !key) return false;
+
+    size_t length = strlen(key);
+    uint64_t prefix = string_prefix(key);
+    SkipNode *preds[SKIPLIST_MAX_HEIGHT];
+    SkipNode *succs[SKIPLIST_MAX_HEIGHT];
+    SkipNode *node = NULL;
+
+    for (;;) {
+        if (skiplist_find(list, key, length, prefix, preds, succs)) return false;
+
+        if (!node) {
+            // A lost race keeps this node for the next attempt
+            node = skiplist_create_node(list, skiplist_random_height());
+            node->key = shared_pool_strndup(list->pool, key, length);
+            node->prefix = prefix;
+            node->length = length;
+        }
+        for (uint32_t level = 0; level < node->height; level++) {
+            atomic_store_explicit(&node->next[level], succs[level], memory_order_relaxed);
+        }
+
+        SkipNode *expected = succs[0];
+        if (atomic_compare_exchange_strong_explicit(&preds[0]->next[0], &expected, node,
+                                                    memory_order_release, memory_order_relaxed)) {
+            break;
+        }
+    }
+    atomic_fetch_add_explicit(&list->size, 1, memory_order_relaxed);
+
+    for (uint32_t level = 1; level < node->height; level++) {
+        for (;;) {
+            SkipNode *expected = succs[level];
+            atomic_store_explicit(&node->next[level], expected, memory_order_relaxed);
+            if (atomic_compare_exchange_strong_explicit(&preds[level]->next[level], &expected, node,
+                                                        memory_order_release, memory_order_relaxed)) {
+                break;
+            }
+            skiplist_find(list, key, length, prefix, preds, succs);
+        }
+    }
+    return true;
+}
+
+// Search for a key, never blocks and may run alongside adds
+bool skiplist_search(const SkipList *list, const char *key) {
+    if (!list || !key) return false;
+
+    return skiplist_find(list, key, strlen(key), string_prefix(key), NULL, NULL) != NULL;
+}
+
+// Walk level 0, which links every key in sorted order
+void skiplist_for_each(const SkipList *list, void (*visit)(const char *key, void *context), void *context) {
+    if (!list) return;
+
+    SkipNode *node = atomic_load_explicit(&list->head->next[0], memory_order_acquire);
+    while (node) {
+        visit(node->key, context);
+        node = atomic_load_explicit(&node->next[0], memory_order_acquire);
+    }
+}
+
+// Free the skip list, all nodes are released together with the pool
+void skiplist_free(SkipList *list) {
+    if (!list) return;
+
+    shared_pool_free(list->pool);
+    free(list);
+}
+
+// Get the number of keys in the skip list
+size_t skiplist_size(SkipList *list) {
+    return list ? atomic_load(&list->size) : 0;
+}
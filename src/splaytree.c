@@ -0,0 +1,193 @@
+//
+// Semi-splay tree: after every access the path to the accessed node is roughly halved
+//
+
+#include "../include/splaytree.h"
+#include "../include/utils.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct SplayNode {
+    const char* key;            // Key bytes, stored in the pool
+    uint64_t prefix;            // First 8 bytes of key, big-endian, see string_prefix
+    size_t length;              // Length of key
+    struct SplayNode* left;
+    struct SplayNode* right;
+    struct SplayNode* parent;
+} SplayNode;
+
+struct SplayTree {
+    SplayNode* root;
+    size_t size;
+    NodePool* pool;  // Owns every node and key of the tree
+};
+
+SplayTree* splaytree_init() {
+    SplayTree* tree = malloc(sizeof(SplayTree));
+    if (!tree) {
+        fprintf(stderr, "Memory allocation failed for SplayTree\n");
+        exit(EXIT_FAILURE);
+    }
+
+    tree->root = NULL;
+    tree->size = 0;
+    tree->pool = pool_init(sizeof(SplayNode));
+    return tree;
+}
+
+// Free the tree, all nodes are released together with the pool
+void splaytree_free(SplayTree* tree) {
+    if (tree) {
+        pool_free(tree->pool);
+        free(tree);
+    }
+}
+
+SplayNode* splaytree_create_node(SplayTree* tree, const char* key, size_t length, uint64_t prefix, SplayNode* parent) {
+    SplayNode* node = pool_alloc(tree->pool);
+    node->key = pool_strndup(tree->pool, key, length);
+    node->prefix = prefix;
+    node->length = length;
+    node->left = NULL;
+    node->right = NULL;
+    node->parent = parent;
+    return node;
+}
+
+void splaytree_set_left(SplayNode* node, SplayNode* child) {
+    node->left = child;
+    if (child) child->parent = node;
+}
+
+void splaytree_set_right(SplayNode* node, SplayNode* child) {
+    node->right = child;
+    if (child) child->parent = node;
+}
+
+// Semi-splay from x: every step takes x, its parent and its grandparent and rebuilds them as a
+// subtree of height two with the middle key on top, then continues from that middle node.
+// Unlike a full splay, x itself does not end up at the root, but the path to it is about halved
+// at a fraction of the rotations.
+void splaytree_semi_splay(SplayTree* tree, SplayNode* x) {
+    while (x->parent && x->parent->parent) {
+        SplayNode* p = x->parent;
+        SplayNode* g = p->parent;
+        SplayNode* above = g->parent;
+
+        // a < b < c are the three nodes in key order, t1..t4 the subtrees around them
+        SplayNode *a, *b, *c, *t1, *t2, *t3, *t4;
+        if (p == g->left) {
+            if (x == p->left) {
+                a = x; b = p; c = g;
+                t1 = x->left; t2 = x->right; t3 = p->right; t4 = g->right;
+            } else {
+                a = p; b = x; c = g;
+                t1 = p->left; t2 = x->left; t3 = x->right; t4 = g->right;
+            }
+        } else {
+            if (x == p->right) {
+                a = g; b = p; c = x;
+                t1 = g->left; t2 = p->left; t3 = x->left; t4 = x->right;
+            } else {
+                a = g; b = x; c = p;
+                t1 = g->left; t2 = x->left; t3 = x->right; t4 = p->right;
+            }
+        }
+
+        splaytree_set_left(a, t1);
+        splaytree_set_right(a, t2);
+        splaytree_set_left(c, t3);
+        splaytree_set_right(c, t4);
+        splaytree_set_left(b, a);
+        splaytree_set_right(b, c);
+
+        b->parent = above;
+        if (!above) tree->root = b;
+        else if (above->left == g) above->left = b;
+        else above->right = b;
+
+        x = b;
+    }
+}
+
+// Descend to key, skipping the characters shared with both bounds as in searchtree.c.
+// Returns the node holding key, or NULL with last set to the final node visited and cmp to its comparison.
+SplayNode* splaytree_find(const SplayTree* tree, const char* key, size_t length, uint64_t prefix,
+                          SplayNode** last, int* cmp, size_t* depth) {
+    SplayNode* x = tree->root;
+    size_t lower_lcp = 0, upper_lcp = 0;
+    *last = NULL;
+    *cmp = 0;
+    *depth = 0;
+    while (x) {
+        size_t lcp;
+        *last = x;
+        (*depth)++;
+        *cmp = string_compare_prefixed(key, length, prefix, x->key, x->length, x->prefix,
+                                       lower_lcp < upper_lcp ? lower_lcp : upper_lcp, &lcp);
+        if (*cmp == 0) return x;
+        if (*cmp < 0) {
+            upper_lcp = lcp;
+            x = x->left;
+        } else {
+            lower_lcp = lcp;
+            x = x->right;
+        }
+    }
+    return NULL;
+}
+
+// Search for a key, splaying the node found or the last node visited
+bool splaytree_search(SplayTree* tree, const char* key) {
+    if (!tree || !key) return false;
+
+    SplayNode* last;
+    int cmp;
+    size_t depth;
+    SplayNode* found = splaytree_find(tree, key, strlen(key), string_prefix(key), &last, &cmp, &depth);
+    if (last) splaytree_semi_splay(tree, last);
+    return found != NULL;
+}
+
+// Add a key, splaying the new node or the one that already held the key
+bool splaytree_add(SplayTree* tree, const char* key) {
+    if (!tree || !key) return false;
+
+    size_t length = strlen(key);
+    uint64_t prefix = string_prefix(key);
+    SplayNode* last;
+    int cmp;
+    size_t depth;
+    SplayNode* found = splaytree_find(tree, key, length, prefix, &last, &cmp, &depth);
+    if (found) {
+        splaytree_semi_splay(tree, found);
+        return false;
+    }
+
+    SplayNode* node = splaytree_create_node(tree, key, length, prefix, last);
+    if (!last) tree->root = node;
+    else if (cmp < 0) last->left = node;
+    else last->right = node;
+
+    tree->size++;
+    splaytree_semi_splay(tree, node);
+    return true;
+}
+
+size_t splaytree_depth(const SplayTree* tree, const char* key) {
+    if (!tree || !key) return 0;
+
+    SplayNode* last;
+    int cmp;
+    size_t depth;
+    splaytree_find(tree, key, strlen(key), string_prefix(key), &last, &cmp, &depth);
+    return depth;
+}
+
+// Return the size of the tree
+size_t splaytree_size(SplayTree* tree) {
+    return tree ? tree->size : 0;
+}
@@ -2,23 +2,34 @@
 // Created by Gabriel Van Langenhove on 04/12/2024.
 //
 
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "../include/struct_utils.h"
+#include "../include/cyclic.h"
 
 #include "../include/hashtable.h"
 #include "../include/trie.h"
 #include "../include/searchtree.h"
+#include "../include/concurrent_trie.h"
+#include "../include/concurrent_hashtable.h"
+#include "../include/bplustree.h"
+#include "../include/compact_searchtree.h"
+#include "../include/splaytree.h"
+#include "../include/lsmtree.h"
+#include "../include/skiplist.h"
 
 typedef enum { RED, BLACK } Color;
 
 typedef struct Node {
     char* key;
     Color color;
+    uint32_t length;
     struct Node* left;
     struct Node* right;
     struct Node* parent;
+    uint64_t prefix;
 } Node;
 
 struct SearchTree {
@@ -37,6 +48,27 @@ void* init_datastructure(const char* type) {
     if (strcmp(type, "searchtree") == 0) {
         return searchtree_init();
     }
+    if (strcmp(type, "concurrent_trie") == 0) {
+        return concurrent_trie_init();
+    }
+    if (strcmp(type, "concurrent_hashtable") == 0) {
+        return concurrent_hashtable_init();
+    }
+    if (strcmp(type, "bplustree") == 0) {
+        return bplustree_init();
+    }
+    if (strcmp(type, "compact_searchtree") == 0) {
+        return compact_searchtree_init();
+    }
+    if (strcmp(type, "splaytree") == 0) {
+        return splaytree_init();
+    }
+    if (strcmp(type, "lsmtree") == 0) {
+        return lsmtree_init();
+    }
+    if (strcmp(type, "skiplist") == 0) {
+        return skiplist_init();
+    }
 
     fprintf(stderr, "Unknown data structure type: %s\nInside init struct", type);
     return NULL;
@@ -53,13 +85,34 @@ bool add_to_datastructure(void* ds, const char* key, const char* type) {
     if (strcmp(type, "searchtree") == 0) {
         return searchtree_add(ds, key);
     }
+    if (strcmp(type, "concurrent_trie") == 0) {
+        return concurrent_trie_add(ds, key);
+    }
+    if (strcmp(type, "concurrent_hashtable") == 0) {
+        return concurrent_hashtable_add(ds, key);
+    }
+    if (strcmp(type, "bplustree") == 0) {
+        return bplustree_add(ds, key);
+    }
+    if (strcmp(type, "compact_searchtree") == 0) {
+        return compact_searchtree_add(ds, key);
+    }
+    if (strcmp(type, "splaytree") == 0) {
+        return splaytree_add(ds, key);
+    }
+    if (strcmp(type, "lsmtree") == 0) {
+        return lsmtree_add(ds, key);
+    }
+    if (strcmp(type, "skiplist") == 0) {
+        return skiplist_add(ds, key);
+    }
 
     fprintf(stderr, "Unknown data structure type: %s\nFailed to add to struct", type);
     return false;
 }
 
 // Search in the appropriate data structure
-bool search_in_datastructure(const void* ds, const char* key, const char* type) {
+bool search_in_datastructure(void* ds, const char* key, const char* type) {
     if (strcmp(type, "hashtable") == 0) {
         return hashtable_search(ds, key);
     }
@@ -69,6 +122,27 @@ bool search_in_datastructure(const void* ds, const char* key, const char* type)
     if (strcmp(type, "searchtree") == 0) {
         return searchtree_search(ds, key);
     }
+    if (strcmp(type, "concurrent_trie") == 0) {
+        return concurrent_trie_search(ds, key);
+    }
+    if (strcmp(type, "concurrent_hashtable") == 0) {
+        return concurrent_hashtable_search(ds, key);
+    }
+    if (strcmp(type, "bplustree") == 0) {
+        return bplustree_search(ds, key);
+    }
+    if (strcmp(type, "compact_searchtree") == 0) {
+        return compact_searchtree_search(ds, key);
+    }
+    if (strcmp(type, "splaytree") == 0) {
+        return splaytree_search(ds, key);
+    }
+    if (strcmp(type, "lsmtree") == 0) {
+        return lsmtree_search(ds, key);
+    }
+    if (strcmp(type, "skiplist") == 0) {
+        return skiplist_search(ds, key);
+    }
 
     fprintf(stderr, "Unknown data structure type: %s\nFailed to search in struct", type);
     return false;
@@ -85,8 +159,101 @@ void free_datastructure(void* ds, const char* type) {
     else if (strcmp(type, "searchtree") == 0) {
         searchtree_free(ds);
     }
+    else if (strcmp(type, "concurrent_trie") == 0) {
+        concurrent_trie_free(ds);
+    }
+    else if (strcmp(type, "concurrent_hashtable") == 0) {
+        concurrent_hashtable_free(ds);
+    }
+    else if (strcmp(type, "bplustree") == 0) {
+        bplustree_free(ds);
+    }
+    else if (strcmp(type, "compact_searchtree") == 0) {
+        compact_searchtree_free(ds);
+    }
+    else if (strcmp(type, "splaytree") == 0) {
+        splaytree_free(ds);
+    }
+    else if (strcmp(type, "lsmtree") == 0) {
+        lsmtree_free(ds);
+    }
+    else if (strcmp(type, "skiplist") == 0) {
+        skiplist_free(ds);
+    }
     else
     {
         fprintf(stderr, "Unknown data structure type: %s\nFailed to free struct", type);
     }
 }
+
+// Add the canonical form of a raw line, returns false if a rotation of it was already present
+bool add_rotation_to_datastructure(void* ds, const char* line, const char* type) {
+    // The trie canonicalizes while descending, so only a miss builds the canonical form
+    if (strcmp(type, "trie") == 0 && trie_search_rotation(ds, line)) {
+        return false;
+    }
+
+    char* minimal_rotation = lexicographically_minimal_string_rotation(line);
+    bool added = add_to_datastructure(ds, minimal_rotation, type);
+    free(minimal_rotation);
+    return added;
+}
+
+// Add the canonical forms of a batch of raw lines, added[i] tells whether lines[i] was new
+void add_rotation_batch_to_datastructure(void* ds, char** lines, size_t count, const char* type, bool* added) {
+    bool is_trie = strcmp(type, "trie") == 0;
+    if (!is_trie && strcmp(type, "searchtree") != 0) {
+        for (size_t i = 0; i < count; i++) {
+            added[i] = add_rotation_to_datastructure(ds, lines[i], type);
+        }
+        return;
+    }
+
+    // The canonical forms are inserted as one sorted batch. In the trie,
+    // lines already present are settled first by the fused lookup.
+    char** canonical = malloc(count * sizeof(char*));
+    if (!canonical) {
+        fprintf(stderr, "Memory allocation failed for canonical batch\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (is_trie && trie_search_rotation(ds, lines[i])) canonical[i] = NULL;
+        else canonical[i] = lexicographically_minimal_string_rotation(lines[i]);
+    }
+
+    add_canonical_batch_to_datastructure(ds, (const char**)canonical, NULL, count, type, added);
+
+    for (size_t i = 0; i < count; i++) {
+        free(canonical[i]);
+    }
+    free(canonical);
+}
+
+// Hash a canonical key the way the data structure will, 0 for the ones that do not hash
+unsigned int hash_for_datastructure(const char* key, const char* type) {
+    if (strcmp(type, "hashtable") == 0) {
+        return hashtable_hash(key);
+    }
+    return 0;
+}
+
+// Add a batch of canonical keys, added[i] tells whether keys[i] was new. NULL keys are never added.
+// hashes may hold hash_for_datastructure of every key, so the hashing can be done elsewhere.
+void add_canonical_batch_to_datastructure(void* ds, const char** keys, const unsigned int* hashes, size_t count,
+                                          const char* type, bool* added) {
+    if (strcmp(type, "trie") == 0) {
+        trie_insert_batch(ds, keys, count, added);
+        return;
+    }
+    if (strcmp(type, "searchtree") == 0) {
+        searchtree_insert_batch(ds, keys, count, added);
+        return;
+    }
+
+    bool is_hashtable = strcmp(type, "hashtable") == 0;
+    for (size_t i = 0; i < count; i++) {
+        if (!keys[i]) added[i] = false;
+        else if (is_hashtable && hashes) added[i] = hashtable_add_hashed(ds, keys[i], hashes[i]);
+        else added[i] = add_to_datastructure(ds, keys[i], type);
+    }
+}
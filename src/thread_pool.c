@@ -0,0 +1,195 @@
+//
+// Thread pool running parallel loops with range stealing
+//
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "../include/thread_pool.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define THREAD_POOL_CHUNK 16    // Items taken at once, small enough to balance lines of 4 to 4095 characters
+
+// The part of the current range a worker started with. Its owner and thieves alike take
+// chunks from the front with one fetch-and-add, so a range never needs a lock.
+typedef struct ThreadPoolShare {
+    _Alignas(64) atomic_size_t next;
+    size_t end;
+} ThreadPoolShare;
+
+typedef struct ThreadPoolWorker {
+    ThreadPool* pool;
+    size_t index;
+    pthread_t thread;
+} ThreadPoolWorker;
+
+struct ThreadPool {
+    size_t worker_count;
+    ThreadPoolWorker* workers;      // Worker 0 is the thread calling thread_pool_run, it has no thread of its own
+    ThreadPoolShare* shares;        // One per worker
+
+    void (*task)(size_t begin, size_t end, void* context);
+    void (*each)(size_t worker, void* context);     // Set instead of task by thread_pool_run_each
+    void* context;
+
+    pthread_mutex_t lock;
+    pthread_cond_t start;           // Signalled when a new run begins or the pool shuts down
+    pthread_cond_t done;            // Signalled when the last worker finishes a run
+    size_t generation;              // Number of runs started
+    size_t running;                 // Workers still busy with the current run
+    bool shutdown;
+};
+
+// Take the next chunk of a share, returns false once it is exhausted
+bool thread_pool_take(ThreadPoolShare* share, size_t* begin, size_t* end) {
+    if (atomic_load_explicit(&share->next, memory_order_relaxed) >= share->end) return false;
+
+    *begin = atomic_fetch_add_explicit(&share->next, THREAD_POOL_CHUNK, memory_order_relaxed);
+    if (*begin >= share->end) return false;
+    *end = *begin + THREAD_POOL_CHUNK < share->end ? *begin + THREAD_POOL_CHUNK : share->end;
+    return true;
+}
+
+// Work through the own share first, then through those of the other workers
+void thread_pool_work(ThreadPool* pool, size_t index) {
+    if (pool->each) {
+        pool->each(index, pool->context);
+        return;
+    }
+
+    for (size_t i = 0; i < pool->worker_count; i++) {
+        ThreadPoolShare* share = &pool->shares[(index + i) % pool->worker_count];
+        size_t begin, end;
+        while (thread_pool_take(share, &begin, &end)) {
+            pool->task(begin, end, pool->context);
+        }
+    }
+}
+
+void* thread_pool_main(void* argument) {
+    ThreadPoolWorker* worker = argument;
+    ThreadPool* pool = worker->pool;
+    size_t seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (pool->generation == seen && !pool->shutdown) {
+            pthread_cond_wait(&pool->start, &pool->lock);
+        }
+        if (pool->shutdown) break;
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        thread_pool_work(pool, worker->index);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->running == 0) pthread_cond_signal(&pool->done);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+ThreadPool* thread_pool_init(size_t workers) {
+    if (workers == 0) workers = 1;
+
+    ThreadPool* pool = malloc(sizeof(ThreadPool));
+    if (!pool) {
+        fprintf(stderr, "Memory allocation failed for ThreadPool\n");
+        exit(EXIT_FAILURE);
+    }
+    pool->worker_count = workers;
+    pool->workers = malloc(workers * sizeof(ThreadPoolWorker));
+    pool->shares = aligned_alloc(_Alignof(ThreadPoolShare), workers * sizeof(ThreadPoolShare));
+    if (!pool->workers || !pool->shares) {
+        fprintf(stderr, "Memory allocation failed for ThreadPool\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < workers; i++) {
+        atomic_init(&pool->shares[i].next, 0);
+        pool->shares[i].end = 0;
+    }
+
+    pool->task = NULL;
+    pool->each = NULL;
+    pool->context = NULL;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    pool->generation = 0;
+    pool->running = 0;
+    pool->shutdown = false;
+
+    for (size_t i = 0; i < workers; i++) {
+        pool->workers[i] = (ThreadPoolWorker){ pool, i };
+        if (i > 0 && pthread_create(&pool->workers[i].thread, NULL, thread_pool_main, &pool->workers[i]) != 0) {
+            fprintf(stderr, "Failed to start a worker thread\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    return pool;
+}
+
+// Start the current run on every worker, take part as worker 0 and wait for the others
+void thread_pool_start(ThreadPool* pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->running = pool->worker_count - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    thread_pool_work(pool, 0);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->running > 0) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void thread_pool_run(ThreadPool* pool, size_t count, void (*task)(size_t begin, size_t end, void* context),
+                     void* context) {
+    if (count == 0) return;
+
+    // Split the range evenly, the stealing evens out what the split gets wrong
+    for (size_t i = 0; i < pool->worker_count; i++) {
+        atomic_store_explicit(&pool->shares[i].next, count * i / pool->worker_count, memory_order_relaxed);
+        pool->shares[i].end = count * (i + 1) / pool->worker_count;
+    }
+    pool->task = task;
+    pool->each = NULL;
+    pool->context = context;
+    thread_pool_start(pool);
+}
+
+void thread_pool_run_each(ThreadPool* pool, void (*task)(size_t worker, void* context), void* context) {
+    pool->task = NULL;
+    pool->each = task;
+    pool->context = context;
+    thread_pool_start(pool);
+}
+
+size_t thread_pool_workers(const ThreadPool* pool) {
+    return pool->worker_count;
+}
+
+void thread_pool_free(ThreadPool* pool) {
+    if (!pool) return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = true;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+    for (size_t i = 1; i < pool->worker_count; i++) {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->start);
+    pthread_cond_destroy(&pool->done);
+    free(pool->workers);
+    free(pool->shares);
+    free(pool);
+}
@@ -7,55 +7,41 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "../include/utils.h"
 
+#define ROTATION_STACK_CANDIDATES 4096  // Lines up to this length need no heap buffer
+
 // Node structure for the compressed trie
 typedef struct TrieNode {
-    char *substring;              // Compressed string for the node
-    struct TrieNode **children;   // Dynamic array of children
+    const char *substring;        // Compressed string for the node, stored in the pool
+    struct TrieNode *first_child; // First child, siblings are linked through next_sibling
+    struct TrieNode *next_sibling;// Next child of the same parent
+    size_t length;                // Length of substring
     bool is_leaf;                 // Indicates if this node represents the end of a word
-    size_t num_children;          // Number of children
-    size_t capacity;              // Capacity of the children array
 } TrieNode;
 
 // Main trie structure
 struct Trie {
     TrieNode *root;   // Root node of the trie
     size_t size;      // Total number of words in the trie
+    NodePool *pool;   // Owns every node and substring of the trie
 };
 
-// Helper function to create a new trie node
-TrieNode *trie_create_node(const char *substring) {
-    TrieNode *node = malloc(sizeof(TrieNode));
-    if (!node) {
-        fprintf(stderr, "Memory allocation failed for TrieNode\n");
-        exit(EXIT_FAILURE);
-    }
+// Helper function to create a new trie node, substring is copied into the pool
+TrieNode *trie_create_node(Trie *trie, const char *substring, size_t length) {
+    TrieNode *node = pool_alloc(trie->pool);
 
-    node->substring = substring ? my_strdup(substring) : NULL;
-    node->children = NULL;
+    node->substring = pool_strndup(trie->pool, substring, length);
+    node->first_child = NULL;
+    node->next_sibling = NULL;
+    node->length = length;
     node->is_leaf = false;
-    node->num_children = 0;
-    node->capacity = 0;
 
     return node;
 }
 
-// Helper function to free a trie node and its children recursively
-void trie_free_node(TrieNode *node) {
-    if (!node) return;
-
-    free(node->substring);
-
-    for (size_t i = 0; i < node->num_children; i++) {
-        trie_free_node(node->children[i]);
-    }
-
-    free(node->children);
-    free(node);
-}
-
 // Initialize a new compressed trie
 Trie *trie_init() {
     Trie *trie = malloc(sizeof(Trie));
@@ -64,39 +50,52 @@ Trie *trie_init() {
         exit(EXIT_FAILURE);
     }
 
-    trie->root = trie_create_node(NULL);
+    trie->pool = pool_init(sizeof(TrieNode));
+    trie->root = trie_create_node(trie, "", 0);
     trie->size = 0;
 
     return trie;
 }
 
-// Helper function to find the longest common prefix
-size_t trie_longest_common_prefix(const char *a, const char *b) {
+// Helper function to find the longest common prefix of a key and a node substring
+size_t trie_longest_common_prefix(const char *key, const char *substring, size_t length) {
     size_t i = 0;
-    while (a[i] && b[i] && a[i] == b[i]) {
+    while (i < length && key[i] && key[i] == substring[i]) {
         i++;
     }
     return i;
 }
 
-// Helper function to add a child to a node
-void trie_add_child(TrieNode *parent, TrieNode *child) {
-    if (parent->num_children == parent->capacity) {
-        size_t new_capacity = parent->capacity == 0 ? 4 : parent->capacity * 2;
-        parent->children = realloc(parent->children, new_capacity * sizeof(TrieNode *));
-        if (!parent->children) {
-            fprintf(stderr, "Memory reallocation failed for children array\n");
-            exit(EXIT_FAILURE);
-        }
-        parent->capacity = new_capacity;
+// Helper function to append a child after last, the current last child of parent or NULL.
+// Appending keeps the oldest children, which the most keys pass through, first in line.
+void trie_add_child(TrieNode *parent, TrieNode *last, TrieNode *child) {
+    child->next_sibling = NULL;
+    if (last) {
+        last->next_sibling = child;
+    } else {
+        parent->first_child = child;
     }
+}
 
-    parent->children[parent->num_children++] = child;
+// Helper function to split a node after prefix_length characters,
+// both halves keep pointing into the same pooled substring
+void trie_split_node(Trie *trie, TrieNode *node, size_t prefix_length) {
+    TrieNode *split_node = pool_alloc(trie->pool);
+    split_node->substring = node->substring + prefix_length;
+    split_node->length = node->length - prefix_length;
+    split_node->first_child = node->first_child;
+    split_node->next_sibling = NULL;
+    split_node->is_leaf = node->is_leaf;
+
+    node->length = prefix_length;
+    node->first_child = NULL;
+    node->is_leaf = false;
+    trie_add_child(node, NULL, split_node);
 }
 
 // Recursive helper function to add a word to the trie
-bool trie_add_recursive(TrieNode *node, const char *key) {
-    if (!key || !*key) {  // If the key is empty, mark the node as a leaf
+bool trie_add_recursive(Trie *trie, TrieNode *node, const char *key) {
+    if (!*key) {  // If the key is empty, mark the node as a leaf
         if (!node->is_leaf) {
             node->is_leaf = true;
             return true;
@@ -105,49 +104,26 @@ bool trie_add_recursive(TrieNode *node, const char *key) {
     }
 
     // Traverse through children to find a match
-    for (size_t i = 0; i < node->num_children; i++) {
-        TrieNode *child = node->children[i];
-        size_t prefix_length = trie_longest_common_prefix(key, child->substring);
+    TrieNode *last = NULL;
+    for (TrieNode *child = node->first_child; child; last = child, child = child->next_sibling) {
+        size_t prefix_length = trie_longest_common_prefix(key, child->substring, child->length);
 
         if (prefix_length > 0) {
-            if (prefix_length == strlen(child->substring)) {
+            if (prefix_length == child->length) {
                 // Continue adding to the matching child
-                return trie_add_recursive(child, key + prefix_length);
-            }
-            // Split the child node
-            TrieNode *split_node = trie_create_node(child->substring + prefix_length);
-            split_node->children = child->children;
-            split_node->num_children = child->num_children;
-            split_node->capacity = child->capacity;
-            split_node->is_leaf = child->is_leaf;
-
-            free(child->substring);
-            child->substring = malloc(prefix_length + 1);
-            if (!child->substring) {
-                fprintf(stderr, "Memory allocation failed for split substring\n");
-                exit(EXIT_FAILURE);
+                return trie_add_recursive(trie, child, key + prefix_length);
             }
-            memcpy(child->substring, key, prefix_length);
-            child->substring[prefix_length] = '\0';
+            trie_split_node(trie, child, prefix_length);
 
-            child->children = NULL;
-            child->num_children = 0;
-            child->capacity = 0;
-            child->is_leaf = false;
-
-            trie_add_child(child, split_node);
-            TrieNode *new_child = trie_create_node(key + prefix_length);
-            new_child->is_leaf = true;
-            trie_add_child(child, new_child);
-
-            return true;
+            // The key either ends at the split point or continues in a new child
+            return trie_add_recursive(trie, child, key + prefix_length);
         }
     }
 
     // If no match, create a new child
-    TrieNode *new_child = trie_create_node(key);
+    TrieNode *new_child = trie_create_node(trie, key, strlen(key));
     new_child->is_leaf = true;
-    trie_add_child(node, new_child);
+    trie_add_child(node, last, new_child);
 
     return true;
 }
@@ -156,24 +132,143 @@ bool trie_add_recursive(TrieNode *node, const char *key) {
 bool trie_add(Trie *trie, const char *key) {
     if (!trie || !key) return false;
 
-    if (trie_add_recursive(trie->root, key)) {
+    if (trie_add_recursive(trie, trie->root, key)) {
         trie->size++;
         return true;
     }
     return false;
 }
 
+// Batch entry with the position of the key in the caller's array
+typedef struct TrieBatchKey {
+    const char *key;
+    size_t index;
+} TrieBatchKey;
+
+// Node on the path of the previously inserted key, depth counts the key characters up to its end
+typedef struct TriePathEntry {
+    TrieNode *node;
+    size_t depth;
+} TriePathEntry;
+
+int trie_compare_batch_keys(const void *a, const void *b) {
+    const TrieBatchKey *x = a;
+    const TrieBatchKey *y = b;
+    int cmp = strcmp(x->key, y->key);
+    if (cmp != 0) return cmp;
+    return (x->index > y->index) - (x->index < y->index);  // Equal keys keep input order
+}
+
+// Add key starting from the top of the path, pushing every node that is passed on the way
+bool trie_add_along_path(Trie *trie, TriePathEntry **path, size_t *path_length, size_t *path_capacity,
+                         const char *key) {
+    TrieNode *node = (*path)[*path_length - 1].node;
+    size_t depth = (*path)[*path_length - 1].depth;
+
+    while (key[depth]) {
+        if (*path_length == *path_capacity) {
+            *path_capacity *= 2;
+            *path = realloc(*path, *path_capacity * sizeof(TriePathEntry));
+            if (!*path) {
+                fprintf(stderr, "Memory reallocation failed for trie path\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        TrieNode *child = node->first_child;
+        TrieNode *last = NULL;
+        size_t prefix_length = 0;
+        while (child && (prefix_length = trie_longest_common_prefix(key + depth, child->substring, child->length)) == 0) {
+            last = child;
+            child = child->next_sibling;
+        }
+
+        if (!child) {
+            size_t length = strlen(key + depth);
+            TrieNode *new_child = trie_create_node(trie, key + depth, length);
+            new_child->is_leaf = true;
+            trie_add_child(node, last, new_child);
+            (*path)[(*path_length)++] = (TriePathEntry){ new_child, depth + length };
+            return true;
+        }
+
+        if (prefix_length < child->length) {
+            trie_split_node(trie, child, prefix_length);
+        }
+        node = child;
+        depth += prefix_length;
+        (*path)[(*path_length)++] = (TriePathEntry){ node, depth };
+    }
+
+    if (node->is_leaf) return false;
+    node->is_leaf = true;
+    return true;
+}
+
+// Add a batch of keys in sorted order. Consecutive sorted keys share long prefixes, so instead of
+// starting at the root every insertion backs up the previous key's path only as far as their
+// longest common prefix. added[i] tells whether keys[i] was new, as if the keys were added in order.
+void trie_insert_batch(Trie *trie, const char **keys, size_t count, bool *added) {
+    if (!trie || count == 0) return;
+
+    TrieBatchKey *batch = malloc(count * sizeof(TrieBatchKey));
+    size_t path_capacity = 64;
+    TriePathEntry *path = malloc(path_capacity * sizeof(TriePathEntry));
+    if (!batch || !path) {
+        fprintf(stderr, "Memory allocation failed for trie batch\n");
+        exit(EXIT_FAILURE);
+    }
+
+    size_t batch_length = 0;
+    for (size_t i = 0; i < count; i++) {
+        added[i] = false;
+        if (keys[i]) {
+            batch[batch_length++] = (TrieBatchKey){ keys[i], i };
+        }
+    }
+    qsort(batch, batch_length, sizeof(TrieBatchKey), trie_compare_batch_keys);
+
+    path[0] = (TriePathEntry){ trie->root, 0 };
+    size_t path_length = 1;
+    const char *previous = NULL;
+
+    for (size_t i = 0; i < batch_length; i++) {
+        const char *key = batch[i].key;
+        size_t lcp = 0;
+        if (previous) {
+            while (key[lcp] && key[lcp] == previous[lcp]) lcp++;
+            if (!key[lcp] && !previous[lcp]) continue;  // Duplicate within the batch
+        }
+
+        // Keep only the nodes the previous key's path shares with this key
+        while (path_length > 1 && path[path_length - 1].depth > lcp) {
+            path_length--;
+        }
+
+        if (trie_add_along_path(trie, &path, &path_length, &path_capacity, key)) {
+            added[batch[i].index] = true;
+            trie->size++;
+        }
+        previous = key;
+    }
+
+    free(path);
+    free(batch);
+}
+
 // Recursive helper function to search for a word in the trie
 bool trie_search_recursive(const TrieNode *node, const char *key) {
     if (!*key) return node->is_leaf;
 
-    for (size_t i = 0; i < node->num_children; i++) {
-        const TrieNode *child = node->children[i];
-        size_t prefix_length = trie_longest_common_prefix(key, child->substring);
+    for (const TrieNode *child = node->first_child; child; child = child->next_sibling) {
+        size_t prefix_length = trie_longest_common_prefix(key, child->substring, child->length);
 
-        if (prefix_length == strlen(child->substring)) {
+        if (prefix_length == child->length) {
             return trie_search_recursive(child, key + prefix_length);
         }
+        if (prefix_length > 0) {
+            return false;  // Only one child can share the first character
+        }
     }
 
     return false;
@@ -186,11 +281,143 @@ bool trie_search(const Trie *trie, const char *key) {
     return trie_search_recursive(trie->root, key);
 }
 
-// Free the trie and its nodes
+// Follow character c one step down from (node, offset), returns false when the trie has no such path
+bool trie_step(const TrieNode **node, size_t *offset, unsigned char c) {
+    if (*offset < (*node)->length) {
+        if ((unsigned char)(*node)->substring[*offset] != c) return false;
+        (*offset)++;
+        return true;
+    }
+
+    for (const TrieNode *child = (*node)->first_child; child; child = child->next_sibling) {
+        if ((unsigned char)child->substring[0] == c) {
+            *node = child;
+            *offset = 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Follow len characters of s down from (node, offset), comparing whole substring spans at once
+bool trie_walk(const TrieNode **node, size_t *offset, const char *s, size_t len) {
+    while (len > 0) {
+        if (*offset == (*node)->length) {
+            // Only the first character is needed to pick the child
+            if (!trie_step(node, offset, (unsigned char)*s)) return false;
+            s++;
+            len--;
+            continue;
+        }
+
+        size_t span = (*node)->length - *offset;
+        if (span > len) span = len;
+        if (memcmp((*node)->substring + *offset, s, span) != 0) return false;
+
+        *offset += span;
+        s += span;
+        len -= span;
+    }
+    return true;
+}
+
+// Search for the lexicographically minimal rotation of line without building it.
+// All rotations start as candidates; at every depth only those with the smallest next
+// character survive, and the trie is descended with that character in the same step.
+// Two rules keep the candidate set small:
+//  - a candidate c that loses at depth d agreed with the winner on d characters, so every
+//    rotation starting in c..c+d is beaten by the winner's matching shift and is dropped too;
+//  - a candidate within depth + 1 positions after a surviving one describes the same
+//    periodic prefix and can never be strictly smaller, so it is dropped as a duplicate.
+// Surviving candidates are thus more than depth apart, which bounds the total work.
+bool trie_search_rotation(const Trie *trie, const char *line) {
+    if (!trie || !line) return false;
+
+    size_t n = strlen(line);
+    if (n == 0) return trie->root->is_leaf;
+
+    uint32_t stack_candidates[ROTATION_STACK_CANDIDATES];
+    uint32_t *candidates = stack_candidates;
+    if (n > ROTATION_STACK_CANDIDATES) {
+        candidates = malloc(n * sizeof(uint32_t));
+        if (!candidates) {
+            fprintf(stderr, "Memory allocation failed for rotation candidates\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    const TrieNode *node = trie->root;
+    size_t offset = 0;
+
+    // Depth 0 works on the line itself: the candidates are the positions of its smallest character
+    unsigned char first = UINT8_MAX;
+    for (size_t i = 0; i < n; i++) {
+        if ((unsigned char)line[i] < first) first = (unsigned char)line[i];
+    }
+    bool found = trie_step(&node, &offset, first);
+
+    size_t count = 0;
+    for (size_t i = 0; found && i < n; i++) {
+        if ((unsigned char)line[i] == first && (count == 0 || i - candidates[count - 1] > 1)) {
+            candidates[count++] = i;
+        }
+    }
+
+    for (size_t depth = 1; found && depth < n; depth++) {
+        if (count == 1) {
+            // The race is decided, the rest of the rotation can be compared span by span
+            size_t start = candidates[0];
+            size_t pos = start + depth;
+            if (pos < n) {
+                found = trie_walk(&node, &offset, line + pos, n - pos)
+                        && trie_walk(&node, &offset, line, start);
+            } else {
+                found = trie_walk(&node, &offset, line + pos - n, start + n - pos);
+            }
+            break;
+        }
+
+        // Next character of the canonical form is the smallest one among the candidates
+        unsigned char best = UINT8_MAX;
+        for (size_t k = 0; k < count; k++) {
+            size_t pos = candidates[k] + depth;
+            unsigned char c = (unsigned char)line[pos < n ? pos : pos - n];
+            if (c < best) best = c;
+        }
+
+        if (!trie_step(&node, &offset, best)) {
+            found = false;  // The canonical form leaves the trie here
+            break;
+        }
+
+        size_t kept = 0;
+        size_t eliminated_until = 0;
+        for (size_t k = 0; k < count; k++) {
+            size_t candidate = candidates[k];
+            if (candidate < eliminated_until) continue;
+
+            size_t pos = candidate + depth;
+            if ((unsigned char)line[pos < n ? pos : pos - n] != best) {
+                eliminated_until = candidate + depth + 1;
+                continue;
+            }
+            if (kept > 0 && candidate - candidates[kept - 1] <= depth + 1) continue;
+
+            candidates[kept++] = candidate;
+        }
+        count = kept;
+    }
+
+    if (candidates != stack_candidates) free(candidates);
+
+    return found && offset == node->length && node->is_leaf;
+}
+
+// Free the trie, all nodes are released together with the pool
 void trie_free(Trie *trie) {
     if (!trie) return;
 
-    trie_free_node(trie->root);
+    pool_free(trie->pool);
     free(trie);
 }
 
@@ -199,3 +426,249 @@ size_t trie_size(Trie *trie) {
     return trie ? trie->size : 0;
 }
 
+// Immutable double-array trie: a transition from state s on code c leads to t = base[s] + c and
+// is valid only if check[t] == s. Code 0 marks the end of a key, byte values are used as codes.
+// Subtrees that hold a single key are cut off into the tail array as one null-terminated suffix.
+struct FrozenTrie {
+    int32_t *base;          // Children offset of a state, or -(tail offset + 1) for a tail state.
+                            // While building, free slots count their failed fits here instead.
+    int32_t *check;         // Parent state of every used slot, -1 when the slot is free
+    size_t capacity;        // Length of base and check
+    uint32_t *next_free;    // Free slots as a circular doubly-linked list through slot 0, only while building
+    uint32_t *prev_free;
+    char *tail;             // Suffixes of tail states
+    size_t tail_length;
+    size_t tail_capacity;
+    size_t size;            // Number of keys
+};
+
+#define FROZEN_INITIAL_CAPACITY 1024
+#define FROZEN_ALPHABET 256
+#define FROZEN_MAX_TRIES 16     // Failed fits after which a free slot is no longer offered as a base
+
+// Make sure slot index exists, new slots start free
+void frozen_trie_reserve(FrozenTrie *frozen, size_t index) {
+    if (index < frozen->capacity) return;
+    // States and the base offsets pointing at them are stored as int32_t
+    if (index > INT32_MAX) {
+        fprintf(stderr, "Too many states for FrozenTrie\n");
+        exit(EXIT_FAILURE);
+    }
+
+    size_t new_capacity = frozen->capacity;
+    while (new_capacity <= index) new_capacity *= 2;
+
+    frozen->base = realloc(frozen->base, new_capacity * sizeof(int32_t));
+    frozen->check = realloc(frozen->check, new_capacity * sizeof(int32_t));
+    frozen->next_free = realloc(frozen->next_free, new_capacity * sizeof(uint32_t));
+    frozen->prev_free = realloc(frozen->prev_free, new_capacity * sizeof(uint32_t));
+    if (!frozen->base || !frozen->check || !frozen->next_free || !frozen->prev_free) {
+        fprintf(stderr, "Memory reallocation failed for frozen trie\n");
+        exit(EXIT_FAILURE);
+    }
+    // The new slots are free and go to the end of the free list
+    for (size_t i = frozen->capacity; i < new_capacity; i++) {
+        frozen->base[i] = 0;
+        frozen->check[i] = -1;
+        uint32_t last = frozen->prev_free[0];
+        frozen->next_free[last] = (uint32_t)i;
+        frozen->prev_free[i] = last;
+        frozen->next_free[i] = 0;
+        frozen->prev_free[0] = (uint32_t)i;
+    }
+    frozen->capacity = new_capacity;
+}
+
+// Take a free slot out of the free list
+void frozen_trie_unlink_free(FrozenTrie *frozen, size_t slot) {
+    frozen->next_free[frozen->prev_free[slot]] = frozen->next_free[slot];
+    frozen->prev_free[frozen->next_free[slot]] = frozen->prev_free[slot];
+}
+
+// Find the first base at which every code lands on a free slot (first fit). Only bases that put the
+// smallest code on a free slot can fit, so the candidates come from the free list instead of a scan
+// over every slot, which would make building quadratic once the front of the arrays is dense.
+size_t frozen_trie_find_base(FrozenTrie *frozen, const unsigned char *codes, size_t count) {
+    size_t min_code = codes[0];
+    for (size_t i = 1; i < count; i++) {
+        if (codes[i] < min_code) min_code = codes[i];
+    }
+
+    size_t position = frozen->next_free[0];
+    for (;;) {
+        if (position == 0) {
+            // Every free slot was tried, continue with the ones growing the arrays adds
+            size_t last = frozen->prev_free[0];
+            frozen_trie_reserve(frozen, frozen->capacity);
+            position = frozen->next_free[last];
+            continue;
+        }
+
+        // Slot 0 is the root, so every child slot must lie past it
+        if (position > min_code) {
+            size_t base = position - min_code;
+            frozen_trie_reserve(frozen, base + FROZEN_ALPHABET);
+            bool fits = true;
+            for (size_t i = 0; i < count && fits; i++) {
+                fits = frozen->check[base + codes[i]] == -1;
+            }
+            if (fits) return base;
+        }
+
+        // A free slot that keeps failing sits among taken ones, where only a single code still fits.
+        // Dropping it from the list leaves it free but keeps every later search from trying it again.
+        size_t next = frozen->next_free[position];
+        if (count > 1 && ++frozen->base[position] == FROZEN_MAX_TRIES) frozen_trie_unlink_free(frozen, position);
+        position = next;
+    }
+}
+
+// Append a suffix to the tail and return its offset
+size_t frozen_trie_add_tail(FrozenTrie *frozen, const char *suffix, size_t length) {
+    // Tail offsets are stored negated in the int32_t base array
+    if (length + 1 > (size_t)INT32_MAX - frozen->tail_length) {
+        fprintf(stderr, "Tail too long for FrozenTrie\n");
+        exit(EXIT_FAILURE);
+    }
+    if (frozen->tail_length + length + 1 > frozen->tail_capacity) {
+        while (frozen->tail_length + length + 1 > frozen->tail_capacity) frozen->tail_capacity *= 2;
+        frozen->tail = realloc(frozen->tail, frozen->tail_capacity);
+        if (!frozen->tail) {
+            fprintf(stderr, "Memory reallocation failed for frozen trie tail\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    size_t offset = frozen->tail_length;
+    memcpy(frozen->tail + offset, suffix, length);
+    frozen->tail[offset + length] = '\0';
+    frozen->tail_length += length + 1;
+    return offset;
+}
+
+// Claim slot base + code as a child of state parent
+size_t frozen_trie_claim(FrozenTrie *frozen, size_t base, unsigned char code, size_t parent) {
+    size_t slot = base + code;
+    if (frozen->base[slot] < FROZEN_MAX_TRIES) frozen_trie_unlink_free(frozen, slot);
+    frozen->check[slot] = (int32_t)parent;
+    frozen->base[slot] = 0;
+    return slot;
+}
+
+// Lay out the part of node below its first character, starting in state
+void frozen_trie_build(FrozenTrie *frozen, size_t state, const TrieNode *node, size_t offset) {
+    // Inside a label every state has a single transition
+    for (; offset < node->length; offset++) {
+        unsigned char code = (unsigned char)node->substring[offset];
+        size_t base = frozen_trie_find_base(frozen, &code, 1);
+        frozen->base[state] = (int32_t)base;
+        state = frozen_trie_claim(frozen, base, code, state);
+    }
+
+    unsigned char codes[FROZEN_ALPHABET + 1];
+    const TrieNode *children[FROZEN_ALPHABET + 1];
+    size_t count = 0;
+    if (node->is_leaf) {
+        codes[count] = 0;
+        children[count++] = NULL;
+    }
+    for (const TrieNode *child = node->first_child; child; child = child->next_sibling) {
+        codes[count] = (unsigned char)child->substring[0];
+        children[count++] = child;
+    }
+    if (count == 0) return;
+
+    size_t base = frozen_trie_find_base(frozen, codes, count);
+    frozen->base[state] = (int32_t)base;
+    for (size_t i = 0; i < count; i++) {
+        frozen_trie_claim(frozen, base, codes[i], state);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        const TrieNode *child = children[i];
+        if (!child) continue;
+
+        size_t slot = base + codes[i];
+        if (!child->first_child) {
+            // A childless node holds exactly one key, its remaining characters go to the tail
+            size_t tail = frozen_trie_add_tail(frozen, child->substring + 1, child->length - 1);
+            frozen->base[slot] = -(int32_t)(tail + 1);
+        } else {
+            frozen_trie_build(frozen, slot, child, 1);
+        }
+    }
+}
+
+// Compact a built trie into an immutable double-array trie for read-only lookups
+FrozenTrie *trie_freeze(const Trie *trie) {
+    if (!trie) return NULL;
+
+    FrozenTrie *frozen = malloc(sizeof(FrozenTrie));
+    if (!frozen) {
+        fprintf(stderr, "Memory allocation failed for FrozenTrie\n");
+        exit(EXIT_FAILURE);
+    }
+
+    frozen->capacity = FROZEN_INITIAL_CAPACITY;
+    frozen->base = malloc(frozen->capacity * sizeof(int32_t));
+    frozen->check = malloc(frozen->capacity * sizeof(int32_t));
+    frozen->next_free = malloc(frozen->capacity * sizeof(uint32_t));
+    frozen->prev_free = malloc(frozen->capacity * sizeof(uint32_t));
+    frozen->tail_capacity = FROZEN_INITIAL_CAPACITY;
+    frozen->tail = malloc(frozen->tail_capacity);
+    if (!frozen->base || !frozen->check || !frozen->next_free || !frozen->prev_free || !frozen->tail) {
+        fprintf(stderr, "Memory allocation failed for FrozenTrie\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < frozen->capacity; i++) {
+        frozen->base[i] = 0;
+        frozen->check[i] = -1;
+        frozen->next_free[i] = (uint32_t)((i + 1) % frozen->capacity);
+        frozen->prev_free[i] = (uint32_t)((i + frozen->capacity - 1) % frozen->capacity);
+    }
+    frozen->check[0] = -2;  // Root slot, never a child of any state, and the head of the free list
+    frozen->tail_length = 0;
+    frozen->size = trie->size;
+
+    frozen_trie_build(frozen, 0, trie->root, 0);
+
+    // Lookups never need the free list
+    free(frozen->next_free);
+    free(frozen->prev_free);
+    frozen->next_free = NULL;
+    frozen->prev_free = NULL;
+    return frozen;
+}
+
+// Search for a word in the frozen trie
+bool frozen_trie_search(const FrozenTrie *frozen, const char *key) {
+    if (!frozen || !key) return false;
+
+    size_t state = 0;
+    for (;; key++) {
+        int32_t base = frozen->base[state];
+        if (base < 0) {
+            return strcmp(key, frozen->tail + (-(size_t)base - 1)) == 0;
+        }
+
+        size_t next = (size_t)base + (unsigned char)*key;
+        if (next >= frozen->capacity || frozen->check[next] != (int32_t)state) return false;
+        if (!*key) return true;  // End-of-key transition
+        state = next;
+    }
+}
+
+// Get the number of words in the frozen trie
+size_t frozen_trie_size(const FrozenTrie *frozen) {
+    return frozen ? frozen->size : 0;
+}
+
+// Free the frozen trie
+void frozen_trie_free(FrozenTrie *frozen) {
+    if (!frozen) return;
+
+    free(frozen->base);
+    free(frozen->check);
+    free(frozen->tail);
+    free(frozen);
+}
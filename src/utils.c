@@ -5,6 +5,16 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <stdio.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "../include/utils.h"
+
+#define SLAB_SIZE (1 << 20)  // 1 MiB per slab
+#define POOL_ALIGNMENT 8
+#define CACHE_LINE_SIZE 64
+#define SHARED_CHUNK_SIZE (64 << 10)  // 64 KiB handed to one thread at a time
 
 char* my_strdup(const char* s) {
     // Calculate the length of the string and allocate enough memory
@@ -20,4 +30,262 @@ char* my_strdup(const char* s) {
     return duplicate;
 }
 
+uint64_t string_prefix(const char* s) {
+    uint64_t prefix = 0;
+    size_t i = 0;
+    for (; i < 8 && s[i]; i++) {
+        prefix = (prefix << 8) | (unsigned char)s[i];
+    }
+    return i == 0 ? 0 : prefix << (8 * (8 - i));
+}
+
+// Load 8 bytes as a big-endian integer, so integer order equals string order
+static uint64_t load_word(const char* s) {
+    uint64_t word;
+    memcpy(&word, s, sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    return __builtin_bswap64(word);
+#else
+    return word;  // Memory order already is big-endian
+#endif
+}
+
+int string_compare_prefixed(const char* a, size_t a_length, uint64_t a_prefix,
+                            const char* b, size_t b_length, uint64_t b_prefix, size_t offset, size_t* lcp) {
+    if (offset < 8) {
+        if (a_prefix != b_prefix) {
+            *lcp = __builtin_clzll(a_prefix ^ b_prefix) / 8;
+            return a_prefix < b_prefix ? -1 : 1;
+        }
+        if (a_length < 8) {
+            *lcp = a_length;  // Both strings end inside the equal prefix
+            return 0;
+        }
+        offset = 8;
+    }
+
+    // Past the prefix both lengths are known, so compare word by word
+    size_t min_length = a_length < b_length ? a_length : b_length;
+    size_t i = offset;
+    while (i + 8 <= min_length) {
+        uint64_t x = load_word(a + i);
+        uint64_t y = load_word(b + i);
+        if (x != y) {
+            *lcp = i + __builtin_clzll(x ^ y) / 8;
+            return x < y ? -1 : 1;
+        }
+        i += 8;
+    }
+    while (i < min_length && a[i] == b[i]) {
+        i++;
+    }
+    *lcp = i;
+
+    if (i < min_length) return (unsigned char)a[i] - (unsigned char)b[i];
+    return (a_length > b_length) - (a_length < b_length);
+}
+
+typedef struct Slab {
+    struct Slab* next;  // Previously filled slab
+    size_t used;        // Bytes handed out from data
+    size_t capacity;    // Usable bytes in data
+    char data[];
+} Slab;
+
+struct NodePool {
+    size_t node_size;     // Size of one node, rounded up to POOL_ALIGNMENT
+    size_t alignment;     // Cache-line sized nodes start on a cache line
+    Slab* node_slabs;     // Slabs holding only nodes
+    Slab* string_slabs;   // Slabs holding key bytes, kept apart so nodes stay dense
+};
+
+NodePool* pool_init(size_t node_size) {
+    NodePool* pool = malloc(sizeof(NodePool));
+    if (!pool) {
+        fprintf(stderr, "Memory allocation failed for NodePool\n");
+        exit(EXIT_FAILURE);
+    }
+
+    pool->node_size = (node_size + POOL_ALIGNMENT - 1) & ~(size_t)(POOL_ALIGNMENT - 1);
+    pool->alignment = pool->node_size % CACHE_LINE_SIZE == 0 ? CACHE_LINE_SIZE : POOL_ALIGNMENT;
+    pool->node_slabs = NULL;
+    pool->string_slabs = NULL;
+    return pool;
+}
+
+// Take size bytes aligned to alignment from the head slab of the list, starting a new slab when it is full
+static void* slab_take(Slab** list, size_t size, size_t alignment) {
+    Slab* slab = *list;
+    size_t start = 0;
+    if (slab) {
+        uintptr_t next = (uintptr_t)(slab->data + slab->used);
+        start = slab->used + ((alignment - next % alignment) % alignment);
+    }
+
+    if (!slab || start > slab->capacity || slab->capacity - start < size) {
+        size_t capacity = (size > SLAB_SIZE ? size : SLAB_SIZE) + alignment;
+        slab = malloc(sizeof(Slab) + capacity);
+        if (!slab) {
+            fprintf(stderr, "Memory allocation failed for pool slab\n");
+            exit(EXIT_FAILURE);
+        }
+        slab->next = *list;
+        slab->used = 0;
+        slab->capacity = capacity;
+        *list = slab;
+
+        uintptr_t next = (uintptr_t)slab->data;
+        start = (alignment - next % alignment) % alignment;
+    }
+
+    void* ptr = slab->data + start;
+    slab->used = start + size;
+    return ptr;
+}
+
+// Hand out one uninitialised node
+void* pool_alloc(NodePool* pool) {
+    return slab_take(&pool->node_slabs, pool->node_size, pool->alignment);
+}
+
+// Copy len bytes of s into the pool and null-terminate the copy
+char* pool_strndup(NodePool* pool, const char* s, size_t len) {
+    char* copy = slab_take(&pool->string_slabs, len + 1, 1);
+    memcpy(copy, s, len);
+    copy[len] = '\0';
+    return copy;
+}
 
+static void slab_free_list(Slab* slab) {
+    while (slab) {
+        Slab* next = slab->next;
+        free(slab);
+        slab = next;
+    }
+}
+
+// Release every node and string of the pool at once
+void pool_free(NodePool* pool) {
+    if (!pool) return;
+
+    slab_free_list(pool->node_slabs);
+    slab_free_list(pool->string_slabs);
+    free(pool);
+}
+
+typedef struct SharedSlab {
+    struct SharedSlab* next;  // Previously filled slab
+    atomic_size_t used;       // Bytes handed out as chunks, may overshoot capacity
+    size_t capacity;          // Usable bytes in data
+    char data[];
+} SharedSlab;
+
+struct SharedPool {
+    uint64_t id;                   // Unique per pool, so a stale thread chunk is never reused
+    _Atomic(SharedSlab*) slabs;
+};
+
+// Chunk of the pool a thread is currently allocating from
+typedef struct SharedChunk {
+    uint64_t pool_id;
+    char* next;
+    char* end;
+} SharedChunk;
+
+#define SHARED_CHUNK_SLOTS 4  // Pools a thread can alternate between without giving up a chunk
+
+static atomic_uint_fast64_t shared_pool_next_id = 1;
+static _Thread_local SharedChunk shared_chunks[SHARED_CHUNK_SLOTS];
+static _Thread_local unsigned shared_chunk_victim;  // Slot to hand to the next uncached pool
+
+SharedPool* shared_pool_init() {
+    SharedPool* pool = malloc(sizeof(SharedPool));
+    if (!pool) {
+        fprintf(stderr, "Memory allocation failed for SharedPool\n");
+        exit(EXIT_FAILURE);
+    }
+
+    pool->id = atomic_fetch_add(&shared_pool_next_id, 1);
+    atomic_init(&pool->slabs, NULL);
+    return pool;
+}
+
+// Cut a chunk of size bytes out of the head slab, racing threads agree on a new slab by CAS
+static char* shared_pool_take_chunk(SharedPool* pool, size_t size) {
+    SharedSlab* slab = atomic_load_explicit(&pool->slabs, memory_order_acquire);
+    for (;;) {
+        if (slab) {
+            size_t offset = atomic_fetch_add_explicit(&slab->used, size, memory_order_relaxed);
+            if (offset + size <= slab->capacity) {
+                return slab->data + offset;
+            }
+        }
+
+        size_t capacity = size > SLAB_SIZE ? size : SLAB_SIZE;
+        SharedSlab* fresh = malloc(sizeof(SharedSlab) + capacity);
+        if (!fresh) {
+            fprintf(stderr, "Memory allocation failed for shared pool slab\n");
+            exit(EXIT_FAILURE);
+        }
+        fresh->next = slab;
+        atomic_init(&fresh->used, size);
+        fresh->capacity = capacity;
+
+        if (atomic_compare_exchange_strong_explicit(&pool->slabs, &slab, fresh,
+                                                    memory_order_acq_rel, memory_order_acquire)) {
+            return fresh->data;
+        }
+        free(fresh);  // Another thread installed a slab first, slab now holds it
+    }
+}
+
+// Hand out size bytes, 8-byte aligned
+void* shared_pool_alloc(SharedPool* pool, size_t size) {
+    size = (size + POOL_ALIGNMENT - 1) & ~(size_t)(POOL_ALIGNMENT - 1);
+
+    // Keep a chunk per recently used pool, so adding to several structures in turn does not
+    // abandon a nearly unused chunk on every switch
+    SharedChunk* chunk = NULL;
+    for (size_t i = 0; i < SHARED_CHUNK_SLOTS; i++) {
+        if (shared_chunks[i].pool_id == pool->id) {
+            chunk = &shared_chunks[i];
+            break;
+        }
+    }
+    if (!chunk) {
+        chunk = &shared_chunks[shared_chunk_victim++ % SHARED_CHUNK_SLOTS];
+        chunk->pool_id = pool->id;
+        chunk->next = chunk->end = NULL;
+    }
+
+    if ((size_t)(chunk->end - chunk->next) < size) {
+        size_t chunk_size = size > SHARED_CHUNK_SIZE ? size : SHARED_CHUNK_SIZE;
+        chunk->next = shared_pool_take_chunk(pool, chunk_size);
+        chunk->end = chunk->next + chunk_size;
+    }
+
+    void* ptr = chunk->next;
+    chunk->next += size;
+    return ptr;
+}
+
+// Copy len bytes of s into the pool and null-terminate the copy
+char* shared_pool_strndup(SharedPool* pool, const char* s, size_t len) {
+    char* copy = shared_pool_alloc(pool, len + 1);
+    memcpy(copy, s, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+// Release the whole pool, no thread may still be allocating from it
+void shared_pool_free(SharedPool* pool) {
+    if (!pool) return;
+
+    SharedSlab* slab = atomic_load(&pool->slabs);
+    while (slab) {
+        SharedSlab* next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    free(pool);
+}
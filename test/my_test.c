@@ -130,9 +130,11 @@ typedef enum { RED, BLACK } Color;
 typedef struct Node {
     char* key;
     Color color;
+    uint32_t length;
     struct Node* left;
     struct Node* right;
     struct Node* parent;
+    uint64_t prefix;
 } Node;
 
 struct SearchTree {
@@ -173,10 +175,38 @@ void test_trie_varying_lengths(){ test_varying_lengths("trie"); }
 void test_trie_null_and_empty_strings(){ test_null_and_empty_strings("trie"); }
 void test_trie_large_number_of_elements(){ test_large_number_of_elements("trie"); }
 
+void test_concurrent_trie_varying_lengths(){ test_varying_lengths("concurrent_trie"); }
+void test_concurrent_trie_null_and_empty_strings(){ test_null_and_empty_strings("concurrent_trie"); }
+void test_concurrent_trie_large_number_of_elements(){ test_large_number_of_elements("concurrent_trie"); }
+
+void test_concurrent_hashtable_varying_lengths(){ test_varying_lengths("concurrent_hashtable"); }
+void test_concurrent_hashtable_null_and_empty_strings(){ test_null_and_empty_strings("concurrent_hashtable"); }
+void test_concurrent_hashtable_large_number_of_elements(){ test_large_number_of_elements("concurrent_hashtable"); }
+
 void test_searchtree_varying_lengths(){ test_varying_lengths("searchtree"); }
 void test_searchtree_null_and_empty_strings(){ test_null_and_empty_strings("searchtree"); }
 void test_searchtree_large_number_of_elements(){ test_large_number_of_elements("searchtree"); }
 
+void test_bplustree_varying_lengths(){ test_varying_lengths("bplustree"); }
+void test_bplustree_null_and_empty_strings(){ test_null_and_empty_strings("bplustree"); }
+void test_bplustree_large_number_of_elements(){ test_large_number_of_elements("bplustree"); }
+
+void test_compact_searchtree_varying_lengths(){ test_varying_lengths("compact_searchtree"); }
+void test_compact_searchtree_null_and_empty_strings(){ test_null_and_empty_strings("compact_searchtree"); }
+void test_compact_searchtree_large_number_of_elements(){ test_large_number_of_elements("compact_searchtree"); }
+
+void test_splaytree_varying_lengths(){ test_varying_lengths("splaytree"); }
+void test_splaytree_null_and_empty_strings(){ test_null_and_empty_strings("splaytree"); }
+void test_splaytree_large_number_of_elements(){ test_large_number_of_elements("splaytree"); }
+
+void test_lsmtree_varying_lengths(){ test_varying_lengths("lsmtree"); }
+void test_lsmtree_null_and_empty_strings(){ test_null_and_empty_strings("lsmtree"); }
+void test_lsmtree_large_number_of_elements(){ test_large_number_of_elements("lsmtree"); }
+
+void test_skiplist_varying_lengths(){ test_varying_lengths("skiplist"); }
+void test_skiplist_null_and_empty_strings(){ test_null_and_empty_strings("skiplist"); }
+void test_skiplist_large_number_of_elements(){ test_large_number_of_elements("skiplist"); }
+
 TEST_LIST = {
     { "Hashtable varying lengths",            test_hashtable_varying_lengths },
     { "Hashtable collision handling",         test_hashtable_collision_handling },
@@ -187,8 +217,36 @@ TEST_LIST = {
     { "Trie null and empty strings",     test_trie_null_and_empty_strings },
     { "Trie large number of elements",   test_trie_large_number_of_elements },
 
+    { "Concurrent trie varying lengths",            test_concurrent_trie_varying_lengths },
+    { "Concurrent trie null and empty strings",     test_concurrent_trie_null_and_empty_strings },
+    { "Concurrent trie large number of elements",   test_concurrent_trie_large_number_of_elements },
+
+    { "Concurrent hashtable varying lengths",            test_concurrent_hashtable_varying_lengths },
+    { "Concurrent hashtable null and empty strings",     test_concurrent_hashtable_null_and_empty_strings },
+    { "Concurrent hashtable large number of elements",   test_concurrent_hashtable_large_number_of_elements },
+
     { "Searchtree varying lengths",            test_searchtree_varying_lengths },
     { "Searchtree null and empty strings",     test_searchtree_null_and_empty_strings },
     { "Searchtree large number of elements",   test_searchtree_large_number_of_elements },
+
+    { "B+-tree varying lengths",            test_bplustree_varying_lengths },
+    { "B+-tree null and empty strings",     test_bplustree_null_and_empty_strings },
+    { "B+-tree large number of elements",   test_bplustree_large_number_of_elements },
+
+    { "Compact searchtree varying lengths",            test_compact_searchtree_varying_lengths },
+    { "Compact searchtree null and empty strings",     test_compact_searchtree_null_and_empty_strings },
+    { "Compact searchtree large number of elements",   test_compact_searchtree_large_number_of_elements },
+
+    { "Splay tree varying lengths",            test_splaytree_varying_lengths },
+    { "Splay tree null and empty strings",     test_splaytree_null_and_empty_strings },
+    { "Splay tree large number of elements",   test_splaytree_large_number_of_elements },
+
+    { "LSM tree varying lengths",            test_lsmtree_varying_lengths },
+    { "LSM tree null and empty strings",     test_lsmtree_null_and_empty_strings },
+    { "LSM tree large number of elements",   test_lsmtree_large_number_of_elements },
+
+    { "Skip list varying lengths",            test_skiplist_varying_lengths },
+    { "Skip list null and empty strings",     test_skiplist_null_and_empty_strings },
+    { "Skip list large number of elements",   test_skiplist_large_number_of_elements },
     { NULL, NULL },
 };
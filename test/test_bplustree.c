@@ -0,0 +1,142 @@
+#include <stddef.h>
+#include <stdint.h>
+#include "acutest.h"
+#include "../include/bplustree.h"
+
+void test_bplustree_simple_add() {
+    char* a = "abc";
+    char* b = "bca";
+    char* c = "cab";
+    char* d = "cba";
+    char* e = "bac";
+
+    BPlusTree* st = bplustree_init();
+
+    TEST_ASSERT(bplustree_add(st, a));
+    TEST_ASSERT(bplustree_add(st, b));
+    TEST_ASSERT(bplustree_add(st, c));
+    TEST_ASSERT(bplustree_add(st, d));
+    TEST_ASSERT(bplustree_add(st, e));
+    TEST_ASSERT(bplustree_size(st) == 5);
+
+    TEST_ASSERT(!bplustree_add(st, a));
+    TEST_ASSERT(!bplustree_add(st, b));
+    TEST_ASSERT(!bplustree_add(st, c));
+    TEST_ASSERT(!bplustree_add(st, d));
+    TEST_ASSERT(!bplustree_add(st, e));
+    TEST_ASSERT(bplustree_size(st) == 5);
+
+    bplustree_free(st);
+}
+
+void test_bplustree_simple_add_search() {
+    char* a = "abc";
+    char* b = "bca";
+    char* c = "cab";
+    char* d = "cba";
+    char* e = "bac";
+
+    BPlusTree* st = bplustree_init();
+
+    TEST_ASSERT(bplustree_add(st, a));
+    TEST_ASSERT(bplustree_add(st, b));
+    TEST_ASSERT(bplustree_add(st, c));
+    TEST_ASSERT(bplustree_add(st, d));
+    TEST_ASSERT(bplustree_add(st, e));
+
+    TEST_ASSERT(bplustree_search(st, a));
+    TEST_ASSERT(bplustree_search(st, b));
+    TEST_ASSERT(bplustree_search(st, c));
+    TEST_ASSERT(bplustree_search(st, d));
+    TEST_ASSERT(bplustree_search(st, e));
+
+    TEST_ASSERT(!bplustree_add(st, a));
+    TEST_ASSERT(!bplustree_add(st, b));
+    TEST_ASSERT(!bplustree_add(st, c));
+    TEST_ASSERT(!bplustree_add(st, d));
+    TEST_ASSERT(!bplustree_add(st, e));
+
+    bplustree_free(st);
+}
+
+void test_bplustree_independent_strings() {
+    BPlusTree* st = bplustree_init();
+
+    char* original = "test";
+    char* copy = malloc(strlen(original) + 1);
+    strcpy(copy, original);
+
+    TEST_ASSERT_(bplustree_add(st, original), "should be able to add test string");
+    TEST_ASSERT_(!bplustree_add(st, copy), "should not be able to add other string with equal contents again");
+    TEST_ASSERT_(bplustree_search(st, original), "should find added string");
+    TEST_ASSERT_(bplustree_search(st, copy), "should be able to find other string with equal contents");
+
+    free(copy);
+    bplustree_free(st);
+}
+
+void test_bplustree_every_size() {
+    // Every size up to three levels, so leaves and inner nodes split at every position they can fill up to.
+    // The keys are the even numbers, the odd ones in between must stay absent.
+    char key[32];
+    for (size_t n = 1; n <= 1400; ++n) {
+        BPlusTree* st = bplustree_init();
+        for (size_t i = 0; i < n; ++i) {
+            // Ascending, descending, or spread out by a prime larger than n
+            size_t value = n % 3 == 0 ? i : n % 3 == 1 ? n - 1 - i : (i * 7919) % n;
+            snprintf(key, sizeof(key), "%05zu", 2 * value);
+            TEST_ASSERT(bplustree_add(st, key));
+        }
+        TEST_ASSERT(bplustree_size(st) == n);
+        for (size_t value = 0; value <= 2 * n; ++value) {
+            snprintf(key, sizeof(key), "%05zu", value);
+            bool present = value % 2 == 0 && value < 2 * n;
+            TEST_ASSERT_(bplustree_search(st, key) == present, "%s in a tree of %zu keys", key, n);
+        }
+        bplustree_free(st);
+    }
+}
+
+void test_bplustree_equal_prefixes() {
+    BPlusTree* st = bplustree_init();
+
+    // Every key shares the 8-byte inline prefix, so leaves and separators can only be told apart by the
+    // rest of the key. Keys that end at or inside the prefix sort before all of them.
+    const char* short_keys[] = { "", "share", "sharedp", "sharedpr" };
+    const size_t count = 3000;
+    char key[32];
+    for (size_t i = 0; i < count; ++i) {
+        snprintf(key, sizeof(key), "sharedpr%zu", (i * 7919) % count);
+        TEST_ASSERT(bplustree_add(st, key));
+    }
+    for (size_t i = 0; i < sizeof(short_keys) / sizeof(short_keys[0]); ++i) {
+        TEST_ASSERT(!bplustree_search(st, short_keys[i]));
+        TEST_ASSERT(bplustree_add(st, short_keys[i]));
+    }
+    TEST_ASSERT(bplustree_size(st) == count + 4);
+
+    for (size_t i = 0; i < count; ++i) {
+        snprintf(key, sizeof(key), "sharedpr%zu", i);
+        TEST_ASSERT(bplustree_search(st, key));
+        TEST_ASSERT(!bplustree_add(st, key));
+        snprintf(key, sizeof(key), "sharedpr%zu~", i);
+        TEST_ASSERT(!bplustree_search(st, key));
+    }
+    for (size_t i = 0; i < sizeof(short_keys) / sizeof(short_keys[0]); ++i) {
+        TEST_ASSERT(bplustree_search(st, short_keys[i]));
+    }
+    TEST_ASSERT(!bplustree_search(st, "sharedpq"));
+    TEST_ASSERT(!bplustree_search(st, "sharedps"));
+
+    bplustree_free(st);
+}
+
+
+TEST_LIST = {
+        { "BPlusTree simple add",               test_bplustree_simple_add },
+        { "BPlusTree simple add and search",    test_bplustree_simple_add_search },
+        { "BPlusTree independent strings",      test_bplustree_independent_strings },
+        { "BPlusTree every size",               test_bplustree_every_size },
+        { "BPlusTree equal prefixes",           test_bplustree_equal_prefixes },
+        { NULL, NULL }
+};
\ No newline at end of file
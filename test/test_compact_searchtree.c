@@ -0,0 +1,168 @@
+#include <stddef.h>
+#include <stdint.h>
+#include "acutest.h"
+#include "../include/compact_searchtree.h"
+
+void test_compact_searchtree_simple_add() {
+    char* a = "abc";
+    char* b = "bca";
+    char* c = "cab";
+    char* d = "cba";
+    char* e = "bac";
+
+    CompactSearchTree* st = compact_searchtree_init();
+
+    TEST_ASSERT(compact_searchtree_add(st, a));
+    TEST_ASSERT(compact_searchtree_add(st, b));
+    TEST_ASSERT(compact_searchtree_add(st, c));
+    TEST_ASSERT(compact_searchtree_add(st, d));
+    TEST_ASSERT(compact_searchtree_add(st, e));
+    TEST_ASSERT(compact_searchtree_size(st) == 5);
+
+    TEST_ASSERT(!compact_searchtree_add(st, a));
+    TEST_ASSERT(!compact_searchtree_add(st, b));
+    TEST_ASSERT(!compact_searchtree_add(st, c));
+    TEST_ASSERT(!compact_searchtree_add(st, d));
+    TEST_ASSERT(!compact_searchtree_add(st, e));
+    TEST_ASSERT(compact_searchtree_size(st) == 5);
+
+    compact_searchtree_free(st);
+}
+
+void test_compact_searchtree_simple_add_search() {
+    char* a = "abc";
+    char* b = "bca";
+    char* c = "cab";
+    char* d = "cba";
+    char* e = "bac";
+
+    CompactSearchTree* st = compact_searchtree_init();
+
+    TEST_ASSERT(compact_searchtree_add(st, a));
+    TEST_ASSERT(compact_searchtree_add(st, b));
+    TEST_ASSERT(compact_searchtree_add(st, c));
+    TEST_ASSERT(compact_searchtree_add(st, d));
+    TEST_ASSERT(compact_searchtree_add(st, e));
+
+    TEST_ASSERT(compact_searchtree_search(st, a));
+    TEST_ASSERT(compact_searchtree_search(st, b));
+    TEST_ASSERT(compact_searchtree_search(st, c));
+    TEST_ASSERT(compact_searchtree_search(st, d));
+    TEST_ASSERT(compact_searchtree_search(st, e));
+
+    TEST_ASSERT(!compact_searchtree_add(st, a));
+    TEST_ASSERT(!compact_searchtree_add(st, b));
+    TEST_ASSERT(!compact_searchtree_add(st, c));
+    TEST_ASSERT(!compact_searchtree_add(st, d));
+    TEST_ASSERT(!compact_searchtree_add(st, e));
+
+    compact_searchtree_free(st);
+}
+
+void test_compact_searchtree_independent_strings() {
+    CompactSearchTree* st = compact_searchtree_init();
+
+    char* original = "test";
+    char* copy = malloc(strlen(original) + 1);
+    strcpy(copy, original);
+
+    TEST_ASSERT_(compact_searchtree_add(st, original), "should be able to add test string");
+    TEST_ASSERT_(!compact_searchtree_add(st, copy), "should not be able to add other string with equal contents again");
+    TEST_ASSERT_(compact_searchtree_search(st, original), "should find added string");
+    TEST_ASSERT_(compact_searchtree_search(st, copy), "should be able to find other string with equal contents");
+
+    free(copy);
+    compact_searchtree_free(st);
+}
+
+void test_compact_searchtree_node_array_growth() {
+    CompactSearchTree* st = compact_searchtree_init();
+
+    // Nodes link by index into one array, which moves every time it doubles. Checking all keys after each
+    // doubling, up to indices well past 16 bits, makes sure no link was left pointing into the old array.
+    const size_t count = 300000;
+    char key[32];
+    size_t checked = 1024;
+    for (size_t i = 0; i < count; ++i) {
+        snprintf(key, sizeof(key), "%zu", (i * 7919) % count);
+        TEST_ASSERT(compact_searchtree_add(st, key));
+        if (i + 1 == checked) {
+            for (size_t j = 0; j <= i; ++j) {
+                snprintf(key, sizeof(key), "%zu", (j * 7919) % count);
+                TEST_ASSERT(compact_searchtree_search(st, key));
+            }
+            checked *= 2;
+        }
+    }
+    TEST_ASSERT(compact_searchtree_size(st) == count);
+    for (size_t i = 0; i < count; ++i) {
+        snprintf(key, sizeof(key), "%zu", i);
+        TEST_ASSERT(compact_searchtree_search(st, key));
+        snprintf(key, sizeof(key), "%zu", count + i);
+        TEST_ASSERT(!compact_searchtree_search(st, key));
+    }
+
+    compact_searchtree_free(st);
+}
+
+void test_compact_searchtree_insertion_orders() {
+    // Without parent links the fix-up after an insert climbs the path it descended. Ascending, descending
+    // and zigzag orders each keep hitting other recoloring and rotation cases on that path.
+    const size_t count = 100000;
+    char key[32];
+    for (int order = 0; order < 3; ++order) {
+        CompactSearchTree* st = compact_searchtree_init();
+        for (size_t i = 0; i < count; ++i) {
+            size_t value = order == 0 ? i : order == 1 ? count - 1 - i : i % 2 == 0 ? i / 2 : count - 1 - i / 2;
+            snprintf(key, sizeof(key), "%06zu", value);
+            TEST_ASSERT(compact_searchtree_add(st, key));
+        }
+        TEST_ASSERT(compact_searchtree_size(st) == count);
+        for (size_t i = 0; i < count; ++i) {
+            snprintf(key, sizeof(key), "%06zu", i);
+            TEST_ASSERT(compact_searchtree_search(st, key));
+            TEST_ASSERT(!compact_searchtree_add(st, key));
+        }
+        TEST_ASSERT(!compact_searchtree_search(st, "00000"));
+        compact_searchtree_free(st);
+    }
+}
+
+void test_compact_searchtree_long_keys() {
+    CompactSearchTree* st = compact_searchtree_init();
+
+    // Node lengths are 32-bit, keys around 2^16 bytes must not be mixed up
+    const size_t lengths[] = { 65535, 65536, 65537, 70000 };
+    const size_t count = sizeof(lengths) / sizeof(lengths[0]);
+    char* key = malloc(70002);
+    memset(key, 'a', 70000);
+    for (size_t i = 0; i < count; ++i) {
+        key[lengths[i]] = '\0';
+        TEST_ASSERT(compact_searchtree_add(st, key));
+        key[lengths[i]] = 'a';
+    }
+    for (size_t i = 0; i < count; ++i) {
+        key[lengths[i]] = '\0';
+        TEST_ASSERT(compact_searchtree_search(st, key));
+        TEST_ASSERT(!compact_searchtree_add(st, key));
+        key[lengths[i]] = 'a';
+        key[lengths[i] + 1] = '\0';
+        TEST_ASSERT(compact_searchtree_search(st, key) == (i + 1 < count && lengths[i + 1] == lengths[i] + 1));
+        key[lengths[i] + 1] = 'a';
+    }
+    TEST_ASSERT(compact_searchtree_size(st) == count);
+
+    free(key);
+    compact_searchtree_free(st);
+}
+
+
+TEST_LIST = {
+        { "CompactSearchTree simple add",               test_compact_searchtree_simple_add },
+        { "CompactSearchTree simple add and search",    test_compact_searchtree_simple_add_search },
+        { "CompactSearchTree independent strings",      test_compact_searchtree_independent_strings },
+        { "CompactSearchTree node array growth",        test_compact_searchtree_node_array_growth },
+        { "CompactSearchTree insertion orders",         test_compact_searchtree_insertion_orders },
+        { "CompactSearchTree long keys",                test_compact_searchtree_long_keys },
+        { NULL, NULL }
+};
@@ -0,0 +1,197 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <pthread.h>
+#include "acutest.h"
+#include "../include/concurrent_hashtable.h"
+
+#define MWC_A2 0xffa04e67b3c95d86
+#define THREADS 4
+#define SHARED_KEYS 20000
+#define GROWTH_KEYS 50000
+
+// rand() is deprecated, hence this small but efficient random number generator
+uint64_t rand_x, rand_y, rand_c;
+uint64_t next_random() {
+    const uint64_t result = rand_y;
+    const __uint128_t t = MWC_A2 * (__uint128_t)rand_x + rand_c;
+    rand_x = rand_y;
+    rand_y = t;
+    rand_c = t >> 64;
+    return result;
+}
+
+void test_concurrent_hashtable_simple_add_search() {
+    char* a = "abc";
+    char* b = "bca";
+    char* c = "ab";
+    char* d = "abcdefghijklmnopq";
+    char* e = "";
+
+    ConcurrentHashTable* table = concurrent_hashtable_init();
+
+    TEST_ASSERT(concurrent_hashtable_add(table, a));
+    TEST_ASSERT(concurrent_hashtable_add(table, b));
+    TEST_ASSERT(concurrent_hashtable_add(table, c));
+    TEST_ASSERT(concurrent_hashtable_add(table, d));
+    TEST_ASSERT(concurrent_hashtable_add(table, e));
+    TEST_ASSERT(concurrent_hashtable_size(table) == 5);
+
+    TEST_ASSERT(concurrent_hashtable_search(table, a));
+    TEST_ASSERT(concurrent_hashtable_search(table, b));
+    TEST_ASSERT(concurrent_hashtable_search(table, c));
+    TEST_ASSERT(concurrent_hashtable_search(table, d));
+    TEST_ASSERT(concurrent_hashtable_search(table, e));
+    TEST_ASSERT(!concurrent_hashtable_search(table, "a"));
+    TEST_ASSERT(!concurrent_hashtable_search(table, "abcdefghijklmnop"));
+
+    TEST_ASSERT(!concurrent_hashtable_add(table, a));
+    TEST_ASSERT(!concurrent_hashtable_add(table, d));
+    TEST_ASSERT(!concurrent_hashtable_add(table, e));
+    TEST_ASSERT(concurrent_hashtable_size(table) == 5);
+
+    concurrent_hashtable_free(table);
+}
+
+typedef struct {
+    ConcurrentHashTable* table;
+    char (*keys)[8];
+    size_t wins;
+} InsertJob;
+
+void* insert_all_keys(void* arg) {
+    InsertJob* job = arg;
+    for (size_t i = 0; i < SHARED_KEYS; ++i) {
+        if (concurrent_hashtable_add(job->table, job->keys[i])) {
+            job->wins++;
+        }
+    }
+    return NULL;
+}
+
+void test_concurrent_hashtable_one_winner_per_key() {
+    ConcurrentHashTable* table = concurrent_hashtable_init();
+
+    // Short keys over a small alphabet, so the threads keep racing to add the same key
+    static char keys[SHARED_KEYS][8];
+    for (size_t i = 0; i < SHARED_KEYS; ++i) {
+        size_t len = 1 + next_random() % 7;
+        for (size_t j = 0; j < len; ++j) {
+            keys[i][j] = (char) ('a' + next_random() % 4);
+        }
+        keys[i][len] = '\0';
+    }
+
+    pthread_t threads[THREADS];
+    InsertJob jobs[THREADS];
+    for (size_t t = 0; t < THREADS; ++t) {
+        jobs[t] = (InsertJob){ table, keys, 0 };
+        pthread_create(&threads[t], NULL, insert_all_keys, &jobs[t]);
+    }
+    size_t wins = 0;
+    for (size_t t = 0; t < THREADS; ++t) {
+        pthread_join(threads[t], NULL);
+        wins += jobs[t].wins;
+    }
+
+    // Every distinct key was won by exactly one thread
+    ConcurrentHashTable* check = concurrent_hashtable_init();
+    for (size_t i = 0; i < SHARED_KEYS; ++i) {
+        concurrent_hashtable_add(check, keys[i]);
+        TEST_ASSERT(concurrent_hashtable_search(table, keys[i]));
+    }
+    TEST_ASSERT(wins == concurrent_hashtable_size(check));
+    TEST_ASSERT(concurrent_hashtable_size(table) == concurrent_hashtable_size(check));
+
+    concurrent_hashtable_free(check);
+    concurrent_hashtable_free(table);
+}
+
+typedef struct {
+    ConcurrentHashTable* table;
+    size_t missing;
+} ReadJob;
+
+// Keeps looking up the keys added before the writers started while the segments grow underneath
+void* search_first_keys(void* arg) {
+    ReadJob* job = arg;
+    char key[16];
+    for (size_t round = 0; round < 20; ++round) {
+        for (size_t i = 0; i < 1000; ++i) {
+            snprintf(key, sizeof(key), "key%zu", i);
+            if (!concurrent_hashtable_search(job->table, key)) job->missing++;
+        }
+    }
+    return NULL;
+}
+
+void* add_growth_keys(void* arg) {
+    ConcurrentHashTable* table = arg;
+    char key[16];
+    for (size_t i = 1000; i < GROWTH_KEYS; ++i) {
+        snprintf(key, sizeof(key), "key%zu", i);
+        concurrent_hashtable_add(table, key);
+    }
+    return NULL;
+}
+
+void test_concurrent_hashtable_search_during_growth() {
+    ConcurrentHashTable* table = concurrent_hashtable_init();
+    char key[16];
+    for (size_t i = 0; i < 1000; ++i) {
+        snprintf(key, sizeof(key), "key%zu", i);
+        concurrent_hashtable_add(table, key);
+    }
+
+    pthread_t writers[2];
+    pthread_t readers[2];
+    ReadJob jobs[2] = { { table, 0 }, { table, 0 } };
+    for (size_t t = 0; t < 2; ++t) {
+        pthread_create(&writers[t], NULL, add_growth_keys, table);
+        pthread_create(&readers[t], NULL, search_first_keys, &jobs[t]);
+    }
+    for (size_t t = 0; t < 2; ++t) {
+        pthread_join(writers[t], NULL);
+        pthread_join(readers[t], NULL);
+        TEST_ASSERT(jobs[t].missing == 0);
+    }
+    TEST_ASSERT(concurrent_hashtable_size(table) == GROWTH_KEYS);
+
+    concurrent_hashtable_free(table);
+}
+
+
+void test_concurrent_hashtable_tables_in_turn() {
+    // More tables than a thread caches pool chunks for, so the chunk cache also evicts
+    ConcurrentHashTable* tables[6];
+    for (size_t t = 0; t < 6; ++t) {
+        tables[t] = concurrent_hashtable_init();
+    }
+
+    char key[16];
+    for (size_t i = 0; i < SHARED_KEYS; ++i) {
+        snprintf(key, sizeof(key), "key%zu", i);
+        TEST_ASSERT(concurrent_hashtable_add(tables[i % 6], key));
+        if (i % 6 < 2) TEST_ASSERT(concurrent_hashtable_add(tables[i % 6 + 4], key));
+    }
+
+    for (size_t i = 0; i < SHARED_KEYS; ++i) {
+        snprintf(key, sizeof(key), "key%zu", i);
+        for (size_t t = 0; t < 6; ++t) {
+            bool expected = t == i % 6 || (i % 6 < 2 && t == i % 6 + 4);
+            TEST_ASSERT(concurrent_hashtable_search(tables[t], key) == expected);
+        }
+    }
+
+    for (size_t t = 0; t < 6; ++t) {
+        concurrent_hashtable_free(tables[t]);
+    }
+}
+
+TEST_LIST = {
+        { "Concurrent hashtable simple add and search",   test_concurrent_hashtable_simple_add_search },
+        { "Concurrent hashtable one winner per key",      test_concurrent_hashtable_one_winner_per_key },
+        { "Concurrent hashtable search during growth",    test_concurrent_hashtable_search_during_growth },
+        { "Concurrent hashtable tables in turn",          test_concurrent_hashtable_tables_in_turn },
+        { NULL, NULL }
+};
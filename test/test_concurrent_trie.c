@@ -0,0 +1,113 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "acutest.h"
+#include "../include/concurrent_trie.h"
+
+#define MWC_A2 0xffa04e67b3c95d86
+#define THREADS 4
+#define SHARED_KEYS 20000
+
+// rand() is deprecated, hence this small but efficient random number generator
+uint64_t rand_x, rand_y, rand_c;
+uint64_t next_random() {
+    const uint64_t result = rand_y;
+    const __uint128_t t = MWC_A2 * (__uint128_t)rand_x + rand_c;
+    rand_x = rand_y;
+    rand_y = t;
+    rand_c = t >> 64;
+    return result;
+}
+
+void test_concurrent_trie_simple_add_search() {
+    char* a = "abc";
+    char* b = "bca";
+    char* c = "ab";
+    char* d = "abd";
+    char* e = "";
+
+    ConcurrentTrie* trie = concurrent_trie_init();
+
+    TEST_ASSERT(concurrent_trie_add(trie, a));
+    TEST_ASSERT(concurrent_trie_add(trie, b));
+    TEST_ASSERT(concurrent_trie_add(trie, c));
+    TEST_ASSERT(concurrent_trie_add(trie, d));
+    TEST_ASSERT(concurrent_trie_add(trie, e));
+    TEST_ASSERT(concurrent_trie_size(trie) == 5);
+
+    TEST_ASSERT(concurrent_trie_search(trie, a));
+    TEST_ASSERT(concurrent_trie_search(trie, b));
+    TEST_ASSERT(concurrent_trie_search(trie, c));
+    TEST_ASSERT(concurrent_trie_search(trie, d));
+    TEST_ASSERT(concurrent_trie_search(trie, e));
+    TEST_ASSERT(!concurrent_trie_search(trie, "a"));
+    TEST_ASSERT(!concurrent_trie_search(trie, "abcd"));
+
+    TEST_ASSERT(!concurrent_trie_add(trie, a));
+    TEST_ASSERT(!concurrent_trie_add(trie, c));
+    TEST_ASSERT(!concurrent_trie_add(trie, e));
+    TEST_ASSERT(concurrent_trie_size(trie) == 5);
+
+    concurrent_trie_free(trie);
+}
+
+typedef struct {
+    ConcurrentTrie* trie;
+    char (*keys)[8];
+    size_t wins;
+} InsertJob;
+
+void* insert_all_keys(void* arg) {
+    InsertJob* job = arg;
+    for (size_t i = 0; i < SHARED_KEYS; ++i) {
+        if (concurrent_trie_add(job->trie, job->keys[i])) {
+            job->wins++;
+        }
+    }
+    return NULL;
+}
+
+void test_concurrent_trie_one_winner_per_key() {
+    ConcurrentTrie* trie = concurrent_trie_init();
+
+    // Short keys over a small alphabet force races on the same child slots and splits
+    static char keys[SHARED_KEYS][8];
+    for (size_t i = 0; i < SHARED_KEYS; ++i) {
+        size_t len = 1 + next_random() % 7;
+        for (size_t j = 0; j < len; ++j) {
+            keys[i][j] = (char) ('a' + next_random() % 4);
+        }
+        keys[i][len] = '\0';
+    }
+
+    pthread_t threads[THREADS];
+    InsertJob jobs[THREADS];
+    for (size_t t = 0; t < THREADS; ++t) {
+        jobs[t] = (InsertJob){ trie, keys, 0 };
+        pthread_create(&threads[t], NULL, insert_all_keys, &jobs[t]);
+    }
+    size_t wins = 0;
+    for (size_t t = 0; t < THREADS; ++t) {
+        pthread_join(threads[t], NULL);
+        wins += jobs[t].wins;
+    }
+
+    // Every distinct key was won by exactly one thread
+    ConcurrentTrie* check = concurrent_trie_init();
+    for (size_t i = 0; i < SHARED_KEYS; ++i) {
+        concurrent_trie_add(check, keys[i]);
+        TEST_ASSERT(concurrent_trie_search(trie, keys[i]));
+    }
+    TEST_ASSERT(wins == concurrent_trie_size(check));
+    TEST_ASSERT(concurrent_trie_size(trie) == concurrent_trie_size(check));
+
+    concurrent_trie_free(check);
+    concurrent_trie_free(trie);
+}
+
+
+TEST_LIST = {
+        { "Concurrent trie simple add and search",   test_concurrent_trie_simple_add_search },
+        { "Concurrent trie one winner per key",      test_concurrent_trie_one_winner_per_key },
+        { NULL, NULL }
+};
@@ -117,11 +117,38 @@ void test_hashtable_independent_strings() {
     hashtable_free(ht);
 }
 
+void test_hashtable_freeze() {
+    // Sizes from empty up to many displacement buckets
+    const size_t sizes[] = { 0, 1, 2, 5, 6, 100, 20000 };
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+        HashTable* ht = hashtable_init();
+        char key[32];
+        for (size_t i = 0; i < sizes[s]; ++i) {
+            sprintf(key, "%zu?%zu", (i * 7919) % sizes[s], i % 13);
+            hashtable_add(ht, key);
+        }
+
+        FrozenHashTable* frozen = hashtable_freeze(ht);
+        TEST_ASSERT(frozen_hashtable_size(frozen) == hashtable_size(ht));
+        for (size_t i = 0; i < sizes[s]; ++i) {
+            sprintf(key, "%zu?%zu", (i * 7919) % sizes[s], i % 13);
+            TEST_ASSERT(frozen_hashtable_search(frozen, key));
+            sprintf(key, "%zu?%zu", (i * 7919) % sizes[s], 13 + i % 13);
+            TEST_ASSERT(!frozen_hashtable_search(frozen, key));
+        }
+        TEST_ASSERT(!frozen_hashtable_search(frozen, ""));
+
+        frozen_hashtable_free(frozen);
+        hashtable_free(ht);
+    }
+}
+
 
 TEST_LIST = {
         { "HashTable simple add",               test_hashtable_simple_add },
         { "HashTable simple add and search",    test_hashtable_simple_add_search },
         { "HashTable add ascending",            test_hashtable_ascending },
         { "Hashtable independent strings",      test_hashtable_independent_strings },
+        { "HashTable freeze",                   test_hashtable_freeze },
         { NULL, NULL }
 };
\ No newline at end of file
@@ -0,0 +1,180 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "acutest.h"
+#include "../include/io_ring.h"
+#include "../include/block_io.h"
+
+#define BUFFER_SIZE 4096
+
+char* buffers[2];
+
+IoRing* make_ring() {
+    buffers[0] = calloc(1, BUFFER_SIZE);
+    buffers[1] = calloc(1, BUFFER_SIZE);
+    IoRing* ring = io_ring_init(buffers, 2, BUFFER_SIZE);
+    if (!ring) {
+        free(buffers[0]);
+        free(buffers[1]);
+    }
+    return ring;
+}
+
+void free_ring(IoRing* ring) {
+    io_ring_free(ring);
+    free(buffers[0]);
+    free(buffers[1]);
+}
+
+void test_io_ring_pipe_round_trip() {
+    IoRing* ring = make_ring();
+    if (!ring) {
+        TEST_SKIP("io_uring is not available");
+        return;
+    }
+    int fds[2];
+    TEST_ASSERT(pipe(fds) == 0);
+
+    strcpy(buffers[0], "hello ring");
+    io_ring_write(ring, fds[1], 0, buffers[0], 10, -1, 7);
+    io_ring_submit(ring);
+    IoRingCompletion completion;
+    TEST_ASSERT(io_ring_wait(ring, -1, &completion));
+    TEST_ASSERT(completion.tag == 7);
+    TEST_ASSERT(completion.result == 10);
+
+    // The read lands in the second buffer, at an offset into it
+    io_ring_read(ring, fds[0], 1, buffers[1] + 100, BUFFER_SIZE - 100, -1, 9);
+    TEST_ASSERT(io_ring_wait(ring, -1, &completion));
+    TEST_ASSERT(completion.tag == 9);
+    TEST_ASSERT(completion.result == 10);
+    TEST_ASSERT(memcmp(buffers[1] + 100, "hello ring", 10) == 0);
+
+    close(fds[0]);
+    close(fds[1]);
+    free_ring(ring);
+}
+
+void test_io_ring_timeout() {
+    IoRing* ring = make_ring();
+    if (!ring) {
+        TEST_SKIP("io_uring is not available");
+        return;
+    }
+    int fds[2];
+    TEST_ASSERT(pipe(fds) == 0);
+
+    // Nothing to read yet, so neither wait sees the read complete
+    io_ring_read(ring, fds[0], 0, buffers[0], BUFFER_SIZE, -1, 1);
+    IoRingCompletion completion;
+    TEST_ASSERT(!io_ring_wait(ring, 0, &completion));
+    TEST_ASSERT(!io_ring_wait(ring, 20, &completion));
+
+    TEST_ASSERT(write(fds[1], "x", 1) == 1);
+    TEST_ASSERT(io_ring_wait(ring, 1000, &completion));
+    TEST_ASSERT(completion.tag == 1);
+    TEST_ASSERT(completion.result == 1);
+
+    close(fds[0]);
+    close(fds[1]);
+    free_ring(ring);
+}
+
+void test_io_ring_errors() {
+    IoRing* ring = make_ring();
+    if (!ring) {
+        TEST_SKIP("io_uring is not available");
+        return;
+    }
+
+    // Errors come back as -errno in the completion, like the result of read
+    io_ring_read(ring, -1, 0, buffers[0], BUFFER_SIZE, -1, 3);
+    IoRingCompletion completion;
+    TEST_ASSERT(io_ring_wait(ring, -1, &completion));
+    TEST_ASSERT(completion.tag == 3);
+    TEST_ASSERT(completion.result < 0);
+
+    free_ring(ring);
+}
+
+// Every flushed block reaches a pipe right away, not only once all the writer's blocks are taken
+void test_io_ring_writer_flushes_each_block() {
+    int fds[2];
+    TEST_ASSERT(pipe(fds) == 0);
+    BlockWriter* writer = block_writer_ring(fds[1]);
+    if (!writer) {
+        close(fds[0]);
+        close(fds[1]);
+        TEST_SKIP("io_uring is not available");
+        return;
+    }
+
+    for (int i = 0; i < 3 * IO_RING_DEPTH; i++) {
+        char line[16];
+        int length = snprintf(line, sizeof(line), "block%d", i);
+        block_writer_append(writer, line, (size_t)length);
+        block_writer_flush(writer);
+
+        struct pollfd input = { fds[0], POLLIN, 0 };
+        TEST_ASSERT(poll(&input, 1, 1000) == 1);
+        char back[16];
+        TEST_ASSERT(read(fds[0], back, sizeof(back)) == length + 1);
+        TEST_ASSERT(memcmp(back, line, (size_t)length) == 0);
+        TEST_ASSERT(back[length] == '\n');
+    }
+
+    block_writer_free(writer);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+// Every kind of block reader starts at the current file position, also one that is not on a page boundary
+void test_block_reader_file_offset() {
+    char path[] = "/tmp/test_io_ring_XXXXXX";
+    int fd = mkstemp(path);
+    TEST_ASSERT(fd >= 0);
+    unlink(path);
+
+    // A first line of 5000 bytes puts the start of the second one past the first page
+    size_t size = 5000 + 1 + 3 + 1;
+    char* data = malloc(size);
+    memset(data, 'a', 5000);
+    memcpy(data + 5000, "\nbcd\n", 5);
+    TEST_ASSERT(write(fd, data, size) == (ssize_t)size);
+    free(data);
+
+    BlockReader* (*const opens[])(int) = { block_reader_init, block_reader_map, block_reader_ring };
+    for (size_t i = 0; i < sizeof(opens) / sizeof(opens[0]); i++) {
+        TEST_ASSERT(lseek(fd, 5001, SEEK_SET) == 5001);
+        BlockReader* reader = opens[i](fd);
+        if (!reader) continue;  // No io_uring here
+
+        LineSlice* lines;
+        size_t count;
+        TEST_CASE_("reader %zu", i);
+        TEST_ASSERT(block_reader_next(reader, &lines, &count));
+        TEST_ASSERT(count == 1);
+        TEST_ASSERT(lines[0].length == 3 && strcmp(lines[0].data, "bcd") == 0);
+        TEST_ASSERT(!block_reader_next(reader, &lines, &count));
+        block_reader_free(reader);
+    }
+
+    // Nothing left to map
+    TEST_ASSERT(lseek(fd, 0, SEEK_END) == (off_t)size);
+    TEST_ASSERT(block_reader_map(fd) == NULL);
+    close(fd);
+}
+
+TEST_LIST = {
+        { "IoRing pipe round trip", test_io_ring_pipe_round_trip },
+        { "IoRing timeout", test_io_ring_timeout },
+        { "IoRing errors", test_io_ring_errors },
+        { "IoRing writer flushes each block", test_io_ring_writer_flushes_each_block },
+        { "Block reader file offset", test_block_reader_file_offset },
+
+        { NULL, NULL }
+};
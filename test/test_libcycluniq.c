@@ -0,0 +1,204 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "acutest.h"
+#include "../include/cycluniq.h"
+
+#define MWC_A2 0xffa04e67b3c95d86
+#define LINE_COUNT 3000
+
+// rand() is deprecated, hence this small but efficient random number generator
+uint64_t rand_x = 0x2545f4914f6cdd1d, rand_y = 0x9e3779b97f4a7c15, rand_c = 1;
+uint64_t next_random() {
+    const uint64_t result = rand_y;
+    const __uint128_t t = MWC_A2 * (__uint128_t)rand_x + rand_c;
+    rand_x = rand_y;
+    rand_y = t;
+    rand_c = t >> 64;
+    return result;
+}
+
+// Everything the engine emitted, one line after another, per lane
+typedef struct Output {
+    char* text[4];
+    size_t length[4];
+    size_t capacity[4];
+    size_t lines;
+} Output;
+
+void collect(const char* line, size_t length, size_t lane, void* context) {
+    Output* output = context;
+    if (output->length[lane] + length + 1 > output->capacity[lane]) {
+        output->capacity[lane] = 2 * (output->length[lane] + length + 1);
+        output->text[lane] = realloc(output->text[lane], output->capacity[lane]);
+    }
+    memcpy(output->text[lane] + output->length[lane], line, length);
+    output->text[lane][output->length[lane] + length] = '\n';
+    output->length[lane] += length + 1;
+    __atomic_fetch_add(&output->lines, 1, __ATOMIC_RELAXED);
+}
+
+void free_output(Output* output) {
+    for (size_t i = 0; i < 4; i++) free(output->text[i]);
+}
+
+// Short lines over a small alphabet, so that many of them are rotations of each other
+char* make_input(size_t* length) {
+    char* input = malloc(LINE_COUNT * 8);
+    size_t used = 0;
+    for (size_t i = 0; i < LINE_COUNT; i++) {
+        size_t len = 1 + next_random() % 6;
+        for (size_t j = 0; j < len; j++) input[used++] = (char)('a' + next_random() % 3);
+        input[used++] = '\n';
+    }
+    *length = used;
+    return input;
+}
+
+Output run(const char* type, const CycluniqOptions* options, const char* input, size_t length, size_t chunk) {
+    Output output = { 0 };
+    Cycluniq* engine = cycluniq_init(type, options, collect, &output, NULL);
+    TEST_ASSERT(engine != NULL);
+    for (size_t i = 0; i < length; i += chunk) {
+        cycluniq_push(engine, input + i, length - i < chunk ? length - i : chunk);
+    }
+    cycluniq_finish(engine);
+    cycluniq_free(engine);
+    return output;
+}
+
+void test_cycluniq_chunks() {
+    size_t length;
+    char* input = make_input(&length);
+    Output whole = run("hashtable", NULL, input, length, length);
+    TEST_ASSERT(whole.lines > 0 && whole.lines < LINE_COUNT);
+
+    // Chunks that cut lines anywhere give the same lines in the same order
+    size_t chunks[] = { 1, 2, 7, 100, 4096 };
+    for (size_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++) {
+        Output split = run("hashtable", NULL, input, length, chunks[i]);
+        TEST_ASSERT(split.length[0] == whole.length[0]);
+        TEST_ASSERT(memcmp(split.text[0], whole.text[0], whole.length[0]) == 0);
+        free_output(&split);
+    }
+
+    // As do threads and shards
+    CycluniqOptions options = { NULL, 3, 2, false };
+    Output sharded = run("trie", &options, input, length, 333);
+    TEST_ASSERT(sharded.length[0] == whole.length[0]);
+    TEST_ASSERT(memcmp(sharded.text[0], whole.text[0], whole.length[0]) == 0);
+    free_output(&sharded);
+
+    free_output(&whole);
+    free(input);
+}
+
+void test_cycluniq_unordered_lanes() {
+    size_t length;
+    char* input = make_input(&length);
+    Output ordered = run("hashtable", NULL, input, length, length);
+
+    CycluniqOptions options = { NULL, 1, 4, true };
+    Output unordered = run("hashtable", &options, input, length, 1000);
+    size_t total = 0;
+    for (size_t lane = 0; lane < 4; lane++) {
+        TEST_ASSERT(unordered.length[lane] > 0);
+        total += unordered.length[lane];
+    }
+    TEST_ASSERT(total == ordered.length[0]);
+    TEST_ASSERT(unordered.lines == ordered.lines);
+
+    free_output(&unordered);
+    free_output(&ordered);
+    free(input);
+}
+
+void test_cycluniq_finish() {
+    Output output = { 0 };
+    Cycluniq* engine = cycluniq_init("trie", NULL, collect, &output, NULL);
+    cycluniq_push(engine, "abc\nca", 6);
+    TEST_ASSERT(output.lines == 1);
+    cycluniq_push(engine, "b", 1);
+    TEST_ASSERT(output.lines == 1);
+
+    // The last line has no newline, "cab" is a rotation of "abc"
+    cycluniq_finish(engine);
+    TEST_ASSERT(output.lines == 1);
+    cycluniq_push(engine, "xyz", 3);
+    cycluniq_finish(engine);
+    TEST_ASSERT(output.lines == 2);
+    TEST_ASSERT(output.length[0] == 8);
+    TEST_ASSERT(memcmp(output.text[0], "abc\nxyz\n", 8) == 0);
+
+    cycluniq_push(engine, "a b\n", 4);
+    TEST_ASSERT(cycluniq_invalid_lines(engine) == 1);
+
+    cycluniq_free(engine);
+    free_output(&output);
+}
+
+void test_cycluniq_long_line() {
+    // Lines are cut after IO_BLOCK_SIZE - 1 bytes, the rest continues as the next line
+    size_t length = IO_BLOCK_SIZE + 10;
+    char* input = malloc(length + 1);
+    for (size_t i = 0; i < length; i++) input[i] = (char)('a' + next_random() % 26);
+    input[length] = '\n';
+
+    Output output = run("hashtable", NULL, input, length + 1, 65536);
+    TEST_ASSERT(output.lines == 2);
+    TEST_ASSERT(output.length[0] == length + 2);
+    TEST_ASSERT(output.text[0][IO_BLOCK_SIZE - 1] == '\n');
+    TEST_ASSERT(memcmp(output.text[0] + IO_BLOCK_SIZE, input + IO_BLOCK_SIZE - 1, 11) == 0);
+
+    free_output(&output);
+    free(input);
+}
+
+// The engine keeps no pointer to the caller's type string, also not on the shard workers
+void test_cycluniq_type_copied() {
+    size_t length;
+    char* input = make_input(&length);
+    char* type = malloc(16);
+    strcpy(type, "hashtable");
+    CycluniqOptions options = { NULL, 2, 2, false };
+    Output output = { 0 };
+    Cycluniq* engine = cycluniq_init(type, &options, collect, &output, NULL);
+    TEST_ASSERT(engine != NULL);
+    strcpy(type, "nonsense");
+    free(type);
+
+    cycluniq_push(engine, input, length);
+    cycluniq_finish(engine);
+    TEST_ASSERT(output.lines > 0);
+
+    cycluniq_free(engine);
+    free_output(&output);
+    free(input);
+}
+
+void test_cycluniq_errors() {
+    Output output = { 0 };
+    CycluniqError error;
+    TEST_ASSERT(cycluniq_init("nonsense", NULL, collect, &output, &error) == NULL);
+    TEST_ASSERT(error == CYCLUNIQ_BAD_DATASTRUCTURE);
+
+    CycluniqOptions unordered = { NULL, 1, 1, true };
+    TEST_ASSERT(cycluniq_init("hashtable", &unordered, collect, &output, &error) == NULL);
+    TEST_ASSERT(error == CYCLUNIQ_BAD_OPTIONS);
+
+    CycluniqOptions reference = { "/nonexistent/reference.txt", 1, 1, false };
+    TEST_ASSERT(cycluniq_init("hashtable", &reference, collect, &output, &error) == NULL);
+    TEST_ASSERT(error == CYCLUNIQ_BAD_REFERENCE);
+}
+
+TEST_LIST = {
+        { "Cycluniq chunks", test_cycluniq_chunks },
+        { "Cycluniq unordered lanes", test_cycluniq_unordered_lanes },
+        { "Cycluniq finish", test_cycluniq_finish },
+        { "Cycluniq long line", test_cycluniq_long_line },
+        { "Cycluniq type copied", test_cycluniq_type_copied },
+        { "Cycluniq errors", test_cycluniq_errors },
+
+        { NULL, NULL }
+};
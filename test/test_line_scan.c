@@ -0,0 +1,108 @@
+#include <stdlib.h>
+#include <string.h>
+#include "acutest.h"
+#include "../include/line_scan.h"
+
+// Byte by byte reference for line_scan
+const char* expected_scan(const char* data, const char* end, bool* valid) {
+    for (; data < end && *data != '\n'; data++) {
+        unsigned char c = (unsigned char)*data;
+        if (c < ALPHABET_FIRST || c > ALPHABET_LAST) *valid = false;
+    }
+    return data;
+}
+
+void test_line_scan_simple() {
+    const char* text = "abc?~\nxyz";
+    bool valid = true;
+    const char* newline = line_scan(text, text + strlen(text), &valid, NULL);
+    TEST_ASSERT(newline == text + 5);
+    TEST_ASSERT(valid);
+
+    valid = true;
+    const char* end = line_scan(newline + 1, text + strlen(text), &valid, NULL);
+    TEST_ASSERT(end == text + strlen(text));
+    TEST_ASSERT(valid);
+}
+
+void test_line_scan_invalid() {
+    const char* bad[] = { "ab>c", "ab\x7f", "\x80xyz", "ab cd", "abc\r", "\xff" };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        bool valid = true;
+        line_scan(bad[i], bad[i] + strlen(bad[i]), &valid, NULL);
+        TEST_ASSERT(!valid);
+    }
+
+    // Bytes after the newline belong to the next line
+    const char* text = "abcdefghijklmnopqrstuvwxyzabcdefghijklm\n \x7f";
+    bool valid = true;
+    line_scan(text, text + strlen(text), &valid, NULL);
+    TEST_ASSERT(valid);
+}
+
+// Lines of every length around the vector widths, with a newline or a bad byte at every position
+void test_line_scan_positions() {
+    char data[200];
+    for (size_t length = 0; length <= 130; length++) {
+        for (size_t position = 0; position <= length; position++) {
+            for (int kind = 0; kind < 3; kind++) {
+                for (size_t i = 0; i < length; i++) data[i] = (char)('?' + (i * 7) % 64);
+                if (position < length) data[position] = kind == 0 ? '\n' : kind == 1 ? '\x7f' : '=';
+
+                bool valid = true, expected_valid = true;
+                const char* found = line_scan(data, data + length, &valid, NULL);
+                const char* expected = expected_scan(data, data + length, &expected_valid);
+                TEST_ASSERT(found == expected);
+                TEST_ASSERT(valid == expected_valid);
+            }
+        }
+    }
+}
+
+void test_line_scan_random() {
+    srand(43);
+    char data[512];
+    for (int round = 0; round < 20000; round++) {
+        size_t length = rand() % sizeof(data);
+        for (size_t i = 0; i < length; i++) {
+            int r = rand() % 100;
+            data[i] = r == 0 ? '\n' : r == 1 ? (char)(rand() % 256) : (char)('?' + rand() % 64);
+        }
+
+        const char* end = data + length;
+        const char* line = data;
+        while (line < end) {
+            bool valid = true, expected_valid = true;
+            const char* found = line_scan(line, end, &valid, NULL);
+            const char* expected = expected_scan(line, end, &expected_valid);
+            TEST_ASSERT(found == expected);
+            TEST_ASSERT(valid == expected_valid);
+            line = found + 1;
+        }
+    }
+}
+
+void test_line_scan_codes() {
+    char data[100];
+    unsigned char codes[100];
+    for (size_t i = 0; i < 99; i++) data[i] = (char)('?' + i % 64);
+    data[80] = '\n';
+
+    bool valid = true;
+    const char* newline = line_scan(data, data + 99, &valid, codes);
+    TEST_ASSERT(newline == data + 80);
+    TEST_ASSERT(valid);
+    for (size_t i = 0; i < 80; i++) {
+        TEST_ASSERT(codes[i] == i % 64);
+    }
+}
+
+TEST_LIST = {
+        { "Line scan - simple", test_line_scan_simple },
+        { "Line scan - invalid characters", test_line_scan_invalid },
+        { "Line scan - all positions", test_line_scan_positions },
+        { "Line scan - random", test_line_scan_random },
+        { "Line scan - 6-bit codes", test_line_scan_codes },
+
+        { NULL, NULL }
+};
@@ -0,0 +1,194 @@
+#include <stddef.h>
+#include <stdint.h>
+#include "acutest.h"
+#include "../include/lsmtree.h"
+
+void test_lsmtree_simple_add() {
+    char* a = "abc";
+    char* b = "bca";
+    char* c = "cab";
+    char* d = "cba";
+    char* e = "bac";
+
+    LsmTree* st = lsmtree_init();
+
+    TEST_ASSERT(lsmtree_add(st, a));
+    TEST_ASSERT(lsmtree_add(st, b));
+    TEST_ASSERT(lsmtree_add(st, c));
+    TEST_ASSERT(lsmtree_add(st, d));
+    TEST_ASSERT(lsmtree_add(st, e));
+    TEST_ASSERT(lsmtree_size(st) == 5);
+
+    TEST_ASSERT(!lsmtree_add(st, a));
+    TEST_ASSERT(!lsmtree_add(st, b));
+    TEST_ASSERT(!lsmtree_add(st, c));
+    TEST_ASSERT(!lsmtree_add(st, d));
+    TEST_ASSERT(!lsmtree_add(st, e));
+    TEST_ASSERT(lsmtree_size(st) == 5);
+
+    lsmtree_free(st);
+}
+
+void test_lsmtree_simple_add_search() {
+    char* a = "abc";
+    char* b = "bca";
+    char* c = "cab";
+    char* d = "cba";
+    char* e = "bac";
+
+    LsmTree* st = lsmtree_init();
+
+    TEST_ASSERT(lsmtree_add(st, a));
+    TEST_ASSERT(lsmtree_add(st, b));
+    TEST_ASSERT(lsmtree_add(st, c));
+    TEST_ASSERT(lsmtree_add(st, d));
+    TEST_ASSERT(lsmtree_add(st, e));
+
+    TEST_ASSERT(lsmtree_search(st, a));
+    TEST_ASSERT(lsmtree_search(st, b));
+    TEST_ASSERT(lsmtree_search(st, c));
+    TEST_ASSERT(lsmtree_search(st, d));
+    TEST_ASSERT(lsmtree_search(st, e));
+
+    TEST_ASSERT(!lsmtree_add(st, a));
+    TEST_ASSERT(!lsmtree_add(st, b));
+    TEST_ASSERT(!lsmtree_add(st, c));
+    TEST_ASSERT(!lsmtree_add(st, d));
+    TEST_ASSERT(!lsmtree_add(st, e));
+
+    lsmtree_free(st);
+}
+
+void test_lsmtree_independent_strings() {
+    LsmTree* st = lsmtree_init();
+
+    char* original = "test";
+    char* copy = malloc(strlen(original) + 1);
+    strcpy(copy, original);
+
+    TEST_ASSERT_(lsmtree_add(st, original), "should be able to add test string");
+    TEST_ASSERT_(!lsmtree_add(st, copy), "should not be able to add other string with equal contents again");
+    TEST_ASSERT_(lsmtree_search(st, original), "should find added string");
+    TEST_ASSERT_(lsmtree_search(st, copy), "should be able to find other string with equal contents");
+
+    free(copy);
+    lsmtree_free(st);
+}
+
+// Add keys up to count, then check that every key added so far is found and the ones after it are not
+void add_and_check(LsmTree* st, size_t* added, size_t count) {
+    char key[32];
+    for (; *added < count; ++*added) {
+        snprintf(key, sizeof(key), "%zu", (*added * 7919) % 100000);
+        TEST_ASSERT(lsmtree_add(st, key));
+    }
+    for (size_t i = 0; i < count + 100; ++i) {
+        snprintf(key, sizeof(key), "%zu", (i * 7919) % 100000);
+        TEST_ASSERT_(lsmtree_search(st, key) == (i < count), "key %zu of %zu", i, count);
+    }
+}
+
+void test_lsmtree_flush_and_merge() {
+    LsmTree* st = lsmtree_init();
+    LsmStats stats;
+    size_t added = 0;
+
+    // 511 keys all fit in the buffer
+    add_and_check(st, &added, 511);
+    lsmtree_stats(st, &stats);
+    TEST_ASSERT(stats.runs == 0);
+    TEST_ASSERT(stats.entries_written == 0);
+
+    // The 512th fills it, and it is flushed into the first run
+    add_and_check(st, &added, 512);
+    lsmtree_stats(st, &stats);
+    TEST_ASSERT(stats.runs == 1);
+    TEST_ASSERT(stats.entries_written == 512);
+
+    // Level 0 holds up to four buffers, every flush rewrites it whole
+    add_and_check(st, &added, 2048);
+    lsmtree_stats(st, &stats);
+    TEST_ASSERT(stats.runs == 1);
+    TEST_ASSERT(stats.entries_written == 512 + 1024 + 1536 + 2048);
+
+    // The fifth flush overfills level 0, which is merged into level 1 and left empty
+    add_and_check(st, &added, 2560);
+    lsmtree_stats(st, &stats);
+    TEST_ASSERT(stats.runs == 1);
+    TEST_ASSERT(stats.entries_written == 5120 + 2560 + 2560);
+
+    // The next flush starts level 0 again, next to level 1
+    add_and_check(st, &added, 3072);
+    lsmtree_stats(st, &stats);
+    TEST_ASSERT(stats.runs == 2);
+    TEST_ASSERT(stats.keys == 3072);
+
+    lsmtree_free(st);
+}
+
+void test_lsmtree_duplicates_across_levels() {
+    LsmTree* st = lsmtree_init();
+
+    // Six flushes spread the keys over two levels, the last 428 stay in the buffer. Then all are offered again.
+    const size_t count = 3500;
+    char key[32];
+    for (size_t i = 0; i < count; ++i) {
+        snprintf(key, sizeof(key), "%zu", i);
+        TEST_ASSERT(lsmtree_add(st, key));
+    }
+    LsmStats before;
+    lsmtree_stats(st, &before);
+    TEST_ASSERT(before.runs == 2);
+
+    for (size_t i = 0; i < count; ++i) {
+        snprintf(key, sizeof(key), "%zu", i);
+        TEST_ASSERT(!lsmtree_add(st, key));
+    }
+    LsmStats after;
+    lsmtree_stats(st, &after);
+    TEST_ASSERT(after.keys == count);
+    TEST_ASSERT(after.entries_written == before.entries_written);
+    TEST_ASSERT(after.lookups == before.lookups + count);
+    TEST_ASSERT(after.runs_searched - before.runs_searched >= 3072);  // Each key in a run is looked up in one
+
+    lsmtree_free(st);
+}
+
+void test_lsmtree_stats() {
+    LsmTree* st = lsmtree_init();
+
+    // Enough keys for several flushes and merges into deeper levels
+    const size_t count = 50000;
+    char key[32];
+    for (size_t i = 0; i < count; ++i) {
+        snprintf(key, sizeof(key), "%zu", (i * 7919) % count);
+        TEST_ASSERT(lsmtree_add(st, key));
+    }
+    for (size_t i = 0; i < count; ++i) {
+        snprintf(key, sizeof(key), "x%zu", i);
+        TEST_ASSERT(!lsmtree_search(st, key));
+    }
+
+    LsmStats stats;
+    lsmtree_stats(st, &stats);
+    TEST_ASSERT(stats.keys == count);
+    TEST_ASSERT(stats.runs >= 2);
+    TEST_ASSERT(stats.write_amplification >= 1.0);
+    TEST_ASSERT(stats.lookups == 2 * count);
+    // Missing keys are almost always ruled out by the Bloom filters
+    TEST_CHECK_(stats.runs_per_lookup < 0.2, "runs searched per lookup: %f", stats.runs_per_lookup);
+    TEST_ASSERT(stats.bloom_skips > 0);
+
+    lsmtree_free(st);
+}
+
+
+TEST_LIST = {
+        { "LsmTree simple add",               test_lsmtree_simple_add },
+        { "LsmTree simple add and search",    test_lsmtree_simple_add_search },
+        { "LsmTree independent strings",      test_lsmtree_independent_strings },
+        { "LsmTree flush and merge",          test_lsmtree_flush_and_merge },
+        { "LsmTree duplicates across levels", test_lsmtree_duplicates_across_levels },
+        { "LsmTree stats",                    test_lsmtree_stats },
+        { NULL, NULL }
+};
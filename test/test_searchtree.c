@@ -117,11 +117,141 @@ void test_searchtree_independent_strings() {
     searchtree_free(st);
 }
 
+void test_searchtree_shared_prefixes() {
+    SearchTree* st = searchtree_init();
+
+    // Keys that only differ near the end, and keys that are prefixes of each other
+    const size_t count = 2000;
+    char keys[count][64];
+    for (size_t i = 0; i < count; ++i) {
+        size_t len = 40 + next_random() % 20;
+        memset(keys[i], '?', len);
+        keys[i][len - 1 - next_random() % 3] = (char) ('?' + next_random() % 4);
+        keys[i][len] = '\0';
+    }
+    for (size_t i = 0; i < count; ++i) {
+        bool present = searchtree_search(st, keys[i]);
+        TEST_ASSERT(searchtree_add(st, keys[i]) == !present);
+        TEST_ASSERT(searchtree_search(st, keys[i]));
+    }
+    for (size_t i = 0; i < count; ++i) {
+        TEST_ASSERT(searchtree_search(st, keys[i]));
+        keys[i][strlen(keys[i]) - 1] = '~';
+        TEST_ASSERT(!searchtree_search(st, keys[i]));
+    }
+
+    searchtree_free(st);
+}
+
+void test_searchtree_prefix_lengths() {
+    SearchTree* st = searchtree_init();
+
+    // Every prefix of one key, so lengths around the 8-byte inline prefix are all present
+    const char* key = "abcdefghijklmnopqrstuvwx";
+    char buffer[32];
+    for (size_t len = 1; len <= strlen(key); len += 2) {
+        memcpy(buffer, key, len);
+        buffer[len] = '\0';
+        TEST_ASSERT(searchtree_add(st, buffer));
+    }
+    for (size_t len = 1; len <= strlen(key); ++len) {
+        memcpy(buffer, key, len);
+        buffer[len] = '\0';
+        TEST_ASSERT(searchtree_search(st, buffer) == (len % 2 == 1));
+    }
+    TEST_ASSERT(searchtree_size(st) == 12);
+
+    searchtree_free(st);
+}
+
+void test_searchtree_insert_batch() {
+    SearchTree* st = searchtree_init();
+    TEST_ASSERT(searchtree_add(st, "abd"));
+
+    const char* keys[] = { "abc", "ab", "abd", "b", "abc", "abcd", NULL, "a" };
+    const bool expected[] = { true, true, false, true, false, true, false, true };
+    const size_t count = sizeof(keys) / sizeof(keys[0]);
+    bool added[sizeof(keys) / sizeof(keys[0])];
+
+    searchtree_insert_batch(st, keys, count, added);
+    for (size_t i = 0; i < count; ++i) {
+        TEST_CHECK_(added[i] == expected[i], "novelty of key %zu", i);
+        if (keys[i]) {
+            TEST_ASSERT(searchtree_search(st, keys[i]));
+        }
+    }
+    TEST_ASSERT(searchtree_size(st) == 6);
+
+    searchtree_free(st);
+}
+
+void test_searchtree_insert_batch_random() {
+    SearchTree* batched = searchtree_init();
+    SearchTree* single = searchtree_init();
+
+    // Batches land all over an existing tree, the finger must agree with plain adds
+    const size_t batches = 200;
+    const size_t count = 250;
+    char strings[250][8];
+    const char* keys[250];
+    bool added[250];
+    for (size_t b = 0; b < batches; ++b) {
+        for (size_t i = 0; i < count; ++i) {
+            size_t len = 1 + next_random() % 6;
+            for (size_t j = 0; j < len; ++j) {
+                strings[i][j] = (char) ('a' + next_random() % 5);
+            }
+            strings[i][len] = '\0';
+            keys[i] = strings[i];
+        }
+        searchtree_insert_batch(batched, keys, count, added);
+        for (size_t i = 0; i < count; ++i) {
+            TEST_ASSERT(added[i] == searchtree_add(single, keys[i]));
+        }
+        TEST_ASSERT(searchtree_size(batched) == searchtree_size(single));
+    }
+
+    searchtree_free(batched);
+    searchtree_free(single);
+}
+
+void test_searchtree_freeze() {
+    // Sizes around powers of two, so the last level of the layout is full, nearly empty or absent
+    const size_t sizes[] = { 0, 1, 2, 3, 7, 8, 100, 1023, 1024, 20000 };
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+        SearchTree* st = searchtree_init();
+        char key[32];
+        for (size_t i = 0; i < sizes[s]; ++i) {
+            sprintf(key, "%zu?%zu", (i * 7919) % sizes[s], i % 13);
+            searchtree_add(st, key);
+        }
+
+        FrozenSearchTree* frozen = searchtree_freeze(st);
+        TEST_ASSERT(frozen_searchtree_size(frozen) == searchtree_size(st));
+        for (size_t i = 0; i < sizes[s]; ++i) {
+            sprintf(key, "%zu?%zu", (i * 7919) % sizes[s], i % 13);
+            TEST_ASSERT(frozen_searchtree_search(frozen, key));
+            sprintf(key, "%zu?%zu", (i * 7919) % sizes[s], 13 + i % 13);
+            TEST_ASSERT(!frozen_searchtree_search(frozen, key));
+        }
+        TEST_ASSERT(!frozen_searchtree_search(frozen, ""));
+        TEST_ASSERT(!frozen_searchtree_search(frozen, "~"));
+
+        frozen_searchtree_free(frozen);
+        searchtree_free(st);
+    }
+}
+
 
 TEST_LIST = {
         { "SearchTree simple add",               test_searchtree_simple_add },
         { "SearchTree simple add and search",    test_searchtree_simple_add_search },
         { "SearchTree add ascending",            test_searchtree_ascending },
         { "SearchTree independent strings",      test_searchtree_independent_strings },
+        { "SearchTree shared prefixes",          test_searchtree_shared_prefixes },
+        { "SearchTree prefix lengths",           test_searchtree_prefix_lengths },
+        { "SearchTree insert batch",             test_searchtree_insert_batch },
+        { "SearchTree insert batch random",      test_searchtree_insert_batch_random },
+        { "SearchTree freeze",                   test_searchtree_freeze },
         { NULL, NULL }
 };
\ No newline at end of file
@@ -0,0 +1,165 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "acutest.h"
+#include "../include/sharded_set.h"
+#include "../include/struct_utils.h"
+#include "../include/utils.h"
+
+#define KEY_COUNT 5000
+
+// Keys with plenty of repeats, so that duplicates land in the same batch and in later batches
+char** make_keys(size_t count) {
+    char** keys = malloc(count * sizeof(char*));
+    for (size_t i = 0; i < count; i++) {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "key%zu", (i * 7919) % (count / 3));
+        keys[i] = my_strdup(buffer);
+    }
+    return keys;
+}
+
+void fill_shards(const ShardedSet* set, char** keys, unsigned int* hashes, unsigned int* shard_of, size_t count,
+                 const char* type) {
+    for (size_t i = 0; i < count; i++) {
+        hashes[i] = hash_for_datastructure(keys[i], type);
+        shard_of[i] = sharded_set_shard(set, keys[i]);
+    }
+}
+
+// The first occurrence of every key, and only that one, is reported as new, as with a single structure
+void test_sharded_set_first_occurrence(const char* type) {
+    ThreadPool* pool = thread_pool_init(4);
+    ShardedSet* set = sharded_set_init(type, 4);
+    TEST_ASSERT(set != NULL);
+    void* single = init_datastructure(type);
+
+    char** keys = make_keys(KEY_COUNT);
+    unsigned int hashes[KEY_COUNT];
+    unsigned int shard_of[KEY_COUNT];
+    bool added[KEY_COUNT];
+    fill_shards(set, keys, hashes, shard_of, KEY_COUNT, type);
+
+    bool expected[KEY_COUNT];
+    for (size_t i = 0; i < KEY_COUNT; i++) {
+        expected[i] = add_to_datastructure(single, keys[i], type);
+    }
+
+    // Two halves, so keys seen in the first batch come back in the second
+    sharded_set_add_batch(set, pool, keys, hashes, shard_of, KEY_COUNT / 2, added, NULL, NULL);
+    sharded_set_add_batch(set, pool, keys + KEY_COUNT / 2, hashes + KEY_COUNT / 2, shard_of + KEY_COUNT / 2,
+                          KEY_COUNT - KEY_COUNT / 2, added + KEY_COUNT / 2, NULL, NULL);
+
+    size_t new_keys = 0;
+    for (size_t i = 0; i < KEY_COUNT; i++) {
+        TEST_ASSERT(added[i] == expected[i]);
+        new_keys += expected[i];
+    }
+    TEST_ASSERT(sharded_set_size(set) == new_keys);
+
+    free(keys);  // The set freed the keys themselves
+    free_datastructure(single, type);
+    sharded_set_free(set);
+    thread_pool_free(pool);
+}
+
+void test_sharded_set_hashtable() {
+    test_sharded_set_first_occurrence("hashtable");
+}
+
+void test_sharded_set_trie() {
+    test_sharded_set_first_occurrence("trie");
+}
+
+void test_sharded_set_searchtree() {
+    test_sharded_set_first_occurrence("searchtree");
+}
+
+typedef struct Emitted {
+    size_t count[4];
+    bool wrong_shard;
+    const unsigned int* shard_of;
+} Emitted;
+
+void count_emit(size_t index, size_t shard, void* context) {
+    Emitted* emitted = context;
+    emitted->count[shard]++;
+    if (emitted->shard_of[index] != shard) emitted->wrong_shard = true;
+}
+
+void test_sharded_set_emit() {
+    ThreadPool* pool = thread_pool_init(4);
+    ShardedSet* set = sharded_set_init("hashtable", 4);
+    char** keys = make_keys(KEY_COUNT);
+    unsigned int hashes[KEY_COUNT];
+    unsigned int shard_of[KEY_COUNT];
+    bool added[KEY_COUNT];
+    fill_shards(set, keys, hashes, shard_of, KEY_COUNT, "hashtable");
+
+    Emitted emitted = { { 0 }, false, shard_of };
+    sharded_set_add_batch(set, pool, keys, hashes, shard_of, KEY_COUNT, added, count_emit, &emitted);
+
+    size_t total = 0;
+    for (size_t s = 0; s < 4; s++) {
+        TEST_ASSERT(emitted.count[s] > 0);  // Every shard gets a fair part of the keys
+        total += emitted.count[s];
+    }
+    TEST_ASSERT(total == sharded_set_size(set));
+    TEST_ASSERT(!emitted.wrong_shard);
+
+    free(keys);
+    sharded_set_free(set);
+    thread_pool_free(pool);
+}
+
+// With many shards most of them stay empty at first, and are only created once a key reaches them
+void test_sharded_set_many_shards() {
+    ThreadPool* pool = thread_pool_init(SHARDED_SET_MAX_SHARDS);
+    ShardedSet* set = sharded_set_init("hashtable", SHARDED_SET_MAX_SHARDS);
+    void* single = init_datastructure("hashtable");
+
+    char** keys = make_keys(KEY_COUNT);
+    unsigned int hashes[KEY_COUNT];
+    unsigned int shard_of[KEY_COUNT];
+    bool added[KEY_COUNT];
+    fill_shards(set, keys, hashes, shard_of, KEY_COUNT, "hashtable");
+
+    bool expected[KEY_COUNT];
+    for (size_t i = 0; i < KEY_COUNT; i++) {
+        expected[i] = add_to_datastructure(single, keys[i], "hashtable");
+    }
+
+    sharded_set_add_batch(set, pool, keys, hashes, shard_of, 0, added, NULL, NULL);
+    TEST_ASSERT(sharded_set_size(set) == 0);
+    sharded_set_add_batch(set, pool, keys, hashes, shard_of, 3, added, NULL, NULL);
+    sharded_set_add_batch(set, pool, keys + 3, hashes + 3, shard_of + 3, KEY_COUNT - 3, added + 3, NULL, NULL);
+
+    size_t new_keys = 0;
+    for (size_t i = 0; i < KEY_COUNT; i++) {
+        TEST_ASSERT(added[i] == expected[i]);
+        new_keys += expected[i];
+    }
+    TEST_ASSERT(sharded_set_size(set) == new_keys);
+
+    free(keys);
+    free_datastructure(single, "hashtable");
+    sharded_set_free(set);
+    thread_pool_free(pool);
+}
+
+void test_sharded_set_unknown_type() {
+    TEST_ASSERT(sharded_set_init("nonsense", 4) == NULL);
+    TEST_ASSERT(sharded_set_init("hashtable", 0) == NULL);
+    TEST_ASSERT(sharded_set_init("hashtable", SHARDED_SET_MAX_SHARDS + 1) == NULL);
+}
+
+TEST_LIST = {
+        { "ShardedSet hashtable", test_sharded_set_hashtable },
+        { "ShardedSet trie", test_sharded_set_trie },
+        { "ShardedSet searchtree", test_sharded_set_searchtree },
+        { "ShardedSet emit", test_sharded_set_emit },
+        { "ShardedSet many shards", test_sharded_set_many_shards },
+        { "ShardedSet unknown type", test_sharded_set_unknown_type },
+
+        { NULL, NULL }
+};
@@ -0,0 +1,161 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <string.h>
+#include "acutest.h"
+#include "../include/skiplist.h"
+
+#define MWC_A2 0xffa04e67b3c95d86
+#define THREADS 4
+#define SHARED_KEYS 20000
+
+// rand() is deprecated, hence this small but efficient random number generator
+uint64_t rand_x, rand_y, rand_c;
+uint64_t next_random() {
+    const uint64_t result = rand_y;
+    const __uint128_t t = MWC_A2 * (__uint128_t)rand_x + rand_c;
+    rand_x = rand_y;
+    rand_y = t;
+    rand_c = t >> 64;
+    return result;
+}
+
+void test_skiplist_simple_add_search() {
+    char* a = "abc";
+    char* b = "bca";
+    char* c = "ab";
+    char* d = "abd";
+    char* e = "";
+
+    SkipList* list = skiplist_init();
+
+    TEST_ASSERT(skiplist_add(list, a));
+    TEST_ASSERT(skiplist_add(list, b));
+    TEST_ASSERT(skiplist_add(list, c));
+    TEST_ASSERT(skiplist_add(list, d));
+    TEST_ASSERT(skiplist_add(list, e));
+    TEST_ASSERT(skiplist_size(list) == 5);
+
+    TEST_ASSERT(skiplist_search(list, a));
+    TEST_ASSERT(skiplist_search(list, b));
+    TEST_ASSERT(skiplist_search(list, c));
+    TEST_ASSERT(skiplist_search(list, d));
+    TEST_ASSERT(skiplist_search(list, e));
+    TEST_ASSERT(!skiplist_search(list, "a"));
+    TEST_ASSERT(!skiplist_search(list, "abcd"));
+
+    TEST_ASSERT(!skiplist_add(list, a));
+    TEST_ASSERT(!skiplist_add(list, c));
+    TEST_ASSERT(!skiplist_add(list, e));
+    TEST_ASSERT(skiplist_size(list) == 5);
+
+    skiplist_free(list);
+}
+
+typedef struct {
+    SkipList* list;
+    char (*keys)[8];
+    size_t wins;
+} InsertJob;
+
+void* insert_all_keys(void* arg) {
+    InsertJob* job = arg;
+    for (size_t i = 0; i < SHARED_KEYS; ++i) {
+        if (skiplist_add(job->list, job->keys[i])) {
+            job->wins++;
+        }
+    }
+    return NULL;
+}
+
+void test_skiplist_one_winner_per_key() {
+    SkipList* list = skiplist_init();
+
+    // Short keys over a small alphabet force races on the same links
+    static char keys[SHARED_KEYS][8];
+    for (size_t i = 0; i < SHARED_KEYS; ++i) {
+        size_t len = 1 + next_random() % 7;
+        for (size_t j = 0; j < len; ++j) {
+            keys[i][j] = (char) ('a' + next_random() % 4);
+        }
+        keys[i][len] = '\0';
+    }
+
+    pthread_t threads[THREADS];
+    InsertJob jobs[THREADS];
+    for (size_t t = 0; t < THREADS; ++t) {
+        jobs[t] = (InsertJob){ list, keys, 0 };
+        pthread_create(&threads[t], NULL, insert_all_keys, &jobs[t]);
+    }
+    size_t wins = 0;
+    for (size_t t = 0; t < THREADS; ++t) {
+        pthread_join(threads[t], NULL);
+        wins += jobs[t].wins;
+    }
+
+    // Every distinct key was won by exactly one thread
+    SkipList* check = skiplist_init();
+    for (size_t i = 0; i < SHARED_KEYS; ++i) {
+        skiplist_add(check, keys[i]);
+        TEST_ASSERT(skiplist_search(list, keys[i]));
+    }
+    TEST_ASSERT(wins == skiplist_size(check));
+    TEST_ASSERT(skiplist_size(list) == skiplist_size(check));
+
+    skiplist_free(check);
+    skiplist_free(list);
+}
+
+typedef struct {
+    const char* previous;
+    size_t count;
+    bool ordered;
+} OrderCheck;
+
+void check_order(const char* key, void* context) {
+    OrderCheck* check = context;
+    if (check->previous && strcmp(check->previous, key) >= 0) {
+        check->ordered = false;
+    }
+    check->previous = key;
+    check->count++;
+}
+
+void test_skiplist_ordered_iteration() {
+    SkipList* list = skiplist_init();
+
+    static char keys[SHARED_KEYS][8];
+    for (size_t i = 0; i < SHARED_KEYS; ++i) {
+        size_t len = 1 + next_random() % 7;
+        for (size_t j = 0; j < len; ++j) {
+            keys[i][j] = (char) ('a' + next_random() % 26);
+        }
+        keys[i][len] = '\0';
+    }
+
+    pthread_t threads[THREADS];
+    InsertJob jobs[THREADS];
+    for (size_t t = 0; t < THREADS; ++t) {
+        jobs[t] = (InsertJob){ list, keys, 0 };
+        pthread_create(&threads[t], NULL, insert_all_keys, &jobs[t]);
+    }
+    for (size_t t = 0; t < THREADS; ++t) {
+        pthread_join(threads[t], NULL);
+    }
+
+    // Every key shows up exactly once, in strictly increasing order
+    OrderCheck check = { NULL, 0, true };
+    skiplist_for_each(list, check_order, &check);
+    TEST_ASSERT(check.ordered);
+    TEST_ASSERT(check.count == skiplist_size(list));
+
+    skiplist_free(list);
+}
+
+
+TEST_LIST = {
+        { "Skip list simple add and search",   test_skiplist_simple_add_search },
+        { "Skip list one winner per key",      test_skiplist_one_winner_per_key },
+        { "Skip list ordered iteration",       test_skiplist_ordered_iteration },
+        { NULL, NULL }
+};
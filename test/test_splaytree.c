@@ -0,0 +1,187 @@
+#include <stddef.h>
+#include <stdint.h>
+#include "acutest.h"
+#include "../include/splaytree.h"
+
+#define MWC_A2 0xffa04e67b3c95d86
+
+// rand() is deprecated, hence this small but efficient random number generator
+uint64_t rand_x = 0x2545f4914f6cdd1d, rand_y = 0x9e3779b97f4a7c15, rand_c = 1;
+uint64_t next_random() {
+    const uint64_t result = rand_y;
+    const __uint128_t t = MWC_A2 * (__uint128_t)rand_x + rand_c;
+    rand_x = rand_y;
+    rand_y = t;
+    rand_c = t >> 64;
+    return result;
+}
+
+void test_splaytree_simple_add() {
+    char* a = "abc";
+    char* b = "bca";
+    char* c = "cab";
+    char* d = "cba";
+    char* e = "bac";
+
+    SplayTree* st = splaytree_init();
+
+    TEST_ASSERT(splaytree_add(st, a));
+    TEST_ASSERT(splaytree_add(st, b));
+    TEST_ASSERT(splaytree_add(st, c));
+    TEST_ASSERT(splaytree_add(st, d));
+    TEST_ASSERT(splaytree_add(st, e));
+    TEST_ASSERT(splaytree_size(st) == 5);
+
+    TEST_ASSERT(!splaytree_add(st, a));
+    TEST_ASSERT(!splaytree_add(st, b));
+    TEST_ASSERT(!splaytree_add(st, c));
+    TEST_ASSERT(!splaytree_add(st, d));
+    TEST_ASSERT(!splaytree_add(st, e));
+    TEST_ASSERT(splaytree_size(st) == 5);
+
+    splaytree_free(st);
+}
+
+void test_splaytree_simple_add_search() {
+    char* a = "abc";
+    char* b = "bca";
+    char* c = "cab";
+    char* d = "cba";
+    char* e = "bac";
+
+    SplayTree* st = splaytree_init();
+
+    TEST_ASSERT(splaytree_add(st, a));
+    TEST_ASSERT(splaytree_add(st, b));
+    TEST_ASSERT(splaytree_add(st, c));
+    TEST_ASSERT(splaytree_add(st, d));
+    TEST_ASSERT(splaytree_add(st, e));
+
+    TEST_ASSERT(splaytree_search(st, a));
+    TEST_ASSERT(splaytree_search(st, b));
+    TEST_ASSERT(splaytree_search(st, c));
+    TEST_ASSERT(splaytree_search(st, d));
+    TEST_ASSERT(splaytree_search(st, e));
+
+    TEST_ASSERT(!splaytree_add(st, a));
+    TEST_ASSERT(!splaytree_add(st, b));
+    TEST_ASSERT(!splaytree_add(st, c));
+    TEST_ASSERT(!splaytree_add(st, d));
+    TEST_ASSERT(!splaytree_add(st, e));
+
+    splaytree_free(st);
+}
+
+void test_splaytree_independent_strings() {
+    SplayTree* st = splaytree_init();
+
+    char* original = "test";
+    char* copy = malloc(strlen(original) + 1);
+    strcpy(copy, original);
+
+    TEST_ASSERT_(splaytree_add(st, original), "should be able to add test string");
+    TEST_ASSERT_(!splaytree_add(st, copy), "should not be able to add other string with equal contents again");
+    TEST_ASSERT_(splaytree_search(st, original), "should find added string");
+    TEST_ASSERT_(splaytree_search(st, copy), "should be able to find other string with equal contents");
+
+    free(copy);
+    splaytree_free(st);
+}
+
+void test_splaytree_recent_keys_move_up() {
+    SplayTree* st = splaytree_init();
+
+    const size_t count = 100000;
+    char key[32];
+    for (size_t i = 0; i < count; ++i) {
+        snprintf(key, sizeof(key), "%08zu", (i * 7919) % count);
+        TEST_ASSERT(splaytree_add(st, key));
+    }
+
+    // Every access at least roughly halves the path, so a few repeated searches bring a key near the root
+    for (size_t i = 0; i < 100; ++i) {
+        snprintf(key, sizeof(key), "%08zu", next_random() % count);
+        size_t before = splaytree_depth(st, key);
+        TEST_ASSERT(splaytree_search(st, key));
+        TEST_ASSERT(splaytree_depth(st, key) <= before);
+        for (size_t j = 0; j < 20; ++j) {
+            TEST_ASSERT(splaytree_search(st, key));
+        }
+        TEST_CHECK_(splaytree_depth(st, key) <= 3, "depth of %s after repeated searches", key);
+    }
+    TEST_ASSERT(splaytree_size(st) == count);
+
+    splaytree_free(st);
+}
+
+void test_splaytree_working_set() {
+    SplayTree* st = splaytree_init();
+    const size_t count = 100000;
+    char key[32];
+    for (size_t i = 0; i < count; ++i) {
+        snprintf(key, sizeof(key), "%zu", (i * 7919) % count);
+        TEST_ASSERT(splaytree_add(st, key));
+    }
+
+    // A few keys searched over and over gather near the root, not far below the depth of a tree of just
+    // those keys, while a random key lies about 17 levels deep
+    const size_t hot = 16;
+    size_t total_depth = 0;
+    for (size_t round = 0; round < 20; ++round) {
+        total_depth = 0;
+        for (size_t i = 0; i < hot; ++i) {
+            snprintf(key, sizeof(key), "%zu", i * (count / hot));
+            total_depth += splaytree_depth(st, key);
+            TEST_ASSERT(splaytree_search(st, key));
+        }
+    }
+    TEST_CHECK_(total_depth <= 8 * hot, "average depth of the hot keys: %zu / %zu", total_depth, hot);
+    TEST_ASSERT(splaytree_size(st) == count);
+
+    splaytree_free(st);
+}
+
+void test_splaytree_missing_keys() {
+    SplayTree* st = splaytree_init();
+    const size_t count = 10000;
+    char key[32];
+    for (size_t i = 0; i < count; ++i) {
+        snprintf(key, sizeof(key), "%05zu", (i * 7919) % count);
+        TEST_ASSERT(splaytree_add(st, key));
+    }
+
+    // A failed search splays the last node it visited, one of the neighbours of the missing key
+    for (size_t i = 0; i < count; i += 97) {
+        snprintf(key, sizeof(key), "%05zu~", i);
+        TEST_ASSERT(!splaytree_search(st, key));
+    }
+    TEST_ASSERT(splaytree_size(st) == count);
+    for (size_t i = 0; i < count; ++i) {
+        snprintf(key, sizeof(key), "%05zu", i);
+        TEST_ASSERT(splaytree_search(st, key));
+        snprintf(key, sizeof(key), "%05zu~", i);
+        TEST_ASSERT(!splaytree_search(st, key));
+    }
+
+    // Measuring the depth does not splay
+    snprintf(key, sizeof(key), "%05zu", count / 3);
+    size_t depth = splaytree_depth(st, key);
+    for (size_t i = 0; i < count; i += 101) {
+        char other[32];
+        snprintf(other, sizeof(other), "%05zu", i);
+        splaytree_depth(st, other);
+    }
+    TEST_ASSERT(splaytree_depth(st, key) == depth);
+
+    splaytree_free(st);
+}
+
+TEST_LIST = {
+        { "SplayTree simple add",               test_splaytree_simple_add },
+        { "SplayTree simple add and search",    test_splaytree_simple_add_search },
+        { "SplayTree independent strings",      test_splaytree_independent_strings },
+        { "SplayTree recent keys move up",      test_splaytree_recent_keys_move_up },
+        { "SplayTree working set",              test_splaytree_working_set },
+        { "SplayTree missing keys",             test_splaytree_missing_keys },
+        { NULL, NULL }
+};
@@ -0,0 +1,68 @@
+#include <stdatomic.h>
+#include <stdlib.h>
+#include "acutest.h"
+#include "../include/thread_pool.h"
+
+typedef struct Visits {
+    atomic_int* counts;
+    atomic_size_t total;
+} Visits;
+
+void visit_range(size_t begin, size_t end, void* context) {
+    Visits* visits = context;
+    for (size_t i = begin; i < end; i++) {
+        atomic_fetch_add(&visits->counts[i], 1);
+    }
+    atomic_fetch_add(&visits->total, end - begin);
+}
+
+// Every index is visited exactly once, whatever the number of workers and items
+void test_thread_pool_covers_range() {
+    size_t sizes[] = { 0, 1, 15, 16, 17, 100, 12345 };
+    for (size_t workers = 1; workers <= 5; workers++) {
+        ThreadPool* pool = thread_pool_init(workers);
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+            size_t count = sizes[s];
+            Visits visits;
+            visits.counts = calloc(count + 1, sizeof(atomic_int));
+            atomic_init(&visits.total, 0);
+
+            thread_pool_run(pool, count, visit_range, &visits);
+
+            TEST_ASSERT(atomic_load(&visits.total) == count);
+            for (size_t i = 0; i < count; i++) {
+                TEST_ASSERT(atomic_load(&visits.counts[i]) == 1);
+            }
+            free(visits.counts);
+        }
+        thread_pool_free(pool);
+    }
+}
+
+void slow_range(size_t begin, size_t end, void* context) {
+    atomic_size_t* total = context;
+    for (size_t i = begin; i < end; i++) {
+        // The first items cost far more than the rest, stealing has to balance them
+        volatile size_t work = i < 64 ? 20000 : 10;
+        while (work > 0) work--;
+    }
+    atomic_fetch_add(total, end - begin);
+}
+
+void test_thread_pool_many_runs() {
+    ThreadPool* pool = thread_pool_init(4);
+    for (int run = 0; run < 50; run++) {
+        atomic_size_t total;
+        atomic_init(&total, 0);
+        thread_pool_run(pool, 1000, slow_range, &total);
+        TEST_ASSERT(atomic_load(&total) == 1000);
+    }
+    thread_pool_free(pool);
+}
+
+TEST_LIST = {
+        { "ThreadPool covers the range", test_thread_pool_covers_range },
+        { "ThreadPool many runs", test_thread_pool_many_runs },
+
+        { NULL, NULL }
+};
@@ -1,12 +1,13 @@
 #include <stddef.h>
 #include <stdint.h>
+#include <time.h>
 #include "acutest.h"
 #include "../include/trie.h"
 
 #define MWC_A2 0xffa04e67b3c95d86
 
 // rand() is deprecated, hence this small but efficient random number generator
-uint64_t rand_x, rand_y, rand_c;
+uint64_t rand_x = 0x2545f4914f6cdd1d, rand_y = 0x9e3779b97f4a7c15, rand_c = 1;
 uint64_t next_random() {
     const uint64_t result = rand_y;
     const __uint128_t t = MWC_A2 * (__uint128_t)rand_x + rand_c;
@@ -117,11 +118,180 @@ void test_trie_independent_strings() {
     trie_free(trie);
 }
 
+void test_trie_prefix_keys() {
+    Trie* trie = trie_init();
+
+    TEST_ASSERT(trie_add(trie, "abc"));
+    TEST_ASSERT(trie_add(trie, "ab"));
+    TEST_ASSERT(trie_add(trie, "abd"));
+    TEST_ASSERT(trie_add(trie, "a"));
+    TEST_ASSERT(trie_size(trie) == 4);
+
+    TEST_ASSERT(trie_search(trie, "a"));
+    TEST_ASSERT(trie_search(trie, "ab"));
+    TEST_ASSERT(trie_search(trie, "abc"));
+    TEST_ASSERT(trie_search(trie, "abd"));
+    TEST_ASSERT(!trie_search(trie, "abcd"));
+
+    TEST_ASSERT(!trie_add(trie, "ab"));
+    TEST_ASSERT(!trie_add(trie, "a"));
+    TEST_ASSERT(trie_size(trie) == 4);
+
+    trie_free(trie);
+}
+
+// Naive minimal rotation to check the fused lookup against
+void naive_minimal_rotation(const char* s, char* out) {
+    size_t n = strlen(s);
+    size_t best = 0;
+    for (size_t i = 1; i < n; ++i) {
+        for (size_t k = 0; k < n; ++k) {
+            char a = s[(i + k) % n], b = s[(best + k) % n];
+            if (a != b) {
+                if (a < b) best = i;
+                break;
+            }
+        }
+    }
+    for (size_t k = 0; k < n; ++k) {
+        out[k] = s[(best + k) % n];
+    }
+    out[n] = '\0';
+}
+
+void test_trie_search_rotation() {
+    Trie* trie = trie_init();
+
+    TEST_ASSERT(trie_add(trie, "elsn"));
+    TEST_ASSERT(trie_search_rotation(trie, "snel"));
+    TEST_ASSERT(trie_search_rotation(trie, "lsne"));
+    TEST_ASSERT(!trie_search_rotation(trie, "sneel"));
+    TEST_ASSERT(!trie_search_rotation(trie, "els"));
+
+    // Small alphabets give many periodic strings and long candidate races
+    const size_t count = 20000;
+    char line[32], canonical[32];
+    for (size_t i = 0; i < count; ++i) {
+        size_t len = 1 + next_random() % 12;
+        for (size_t j = 0; j < len; ++j) {
+            line[j] = (char) ('a' + next_random() % 3);
+        }
+        line[len] = '\0';
+        naive_minimal_rotation(line, canonical);
+
+        bool present = trie_search(trie, canonical);
+        TEST_ASSERT(trie_search_rotation(trie, line) == present);
+        if (!present) {
+            TEST_ASSERT(trie_add(trie, canonical));
+            TEST_ASSERT(trie_search_rotation(trie, line));
+        }
+    }
+
+    trie_free(trie);
+}
+
+void test_trie_insert_batch() {
+    Trie* trie = trie_init();
+    TEST_ASSERT(trie_add(trie, "abd"));
+
+    const char* keys[] = { "abc", "ab", "abd", "b", "abc", "abcd", NULL, "a" };
+    const bool expected[] = { true, true, false, true, false, true, false, true };
+    const size_t count = sizeof(keys) / sizeof(keys[0]);
+    bool added[sizeof(keys) / sizeof(keys[0])];
+
+    trie_insert_batch(trie, keys, count, added);
+    for (size_t i = 0; i < count; ++i) {
+        TEST_CHECK_(added[i] == expected[i], "novelty of key %zu", i);
+        if (keys[i]) {
+            TEST_ASSERT(trie_search(trie, keys[i]));
+        }
+    }
+    TEST_ASSERT(trie_size(trie) == 6);
+
+    trie_free(trie);
+}
+
+void test_trie_freeze() {
+    Trie* trie = trie_init();
+
+    const size_t count = 20000;
+    char** strings = malloc(count * sizeof(char*));
+    for (size_t i = 0; i < count; ++i) {
+        size_t len = next_random() % 10;
+        strings[i] = malloc(len + 1);
+        for (size_t j = 0; j < len; ++j) {
+            strings[i][j] = (char) (63 + next_random() % 4);
+        }
+        strings[i][len] = '\0';
+        if (i % 2 == 0) {
+            trie_add(trie, strings[i]);
+        }
+    }
+
+    FrozenTrie* frozen = trie_freeze(trie);
+    TEST_ASSERT(frozen_trie_size(frozen) == trie_size(trie));
+    for (size_t i = 0; i < count; ++i) {
+        TEST_ASSERT(frozen_trie_search(frozen, strings[i]) == trie_search(trie, strings[i]));
+    }
+    TEST_ASSERT(!frozen_trie_search(frozen, "~~~~~~~~~~~"));
+
+    for (size_t i = 0; i < count; ++i) {
+        free(strings[i]);
+    }
+    free(strings);
+    frozen_trie_free(frozen);
+    trie_free(trie);
+}
+
+void test_trie_freeze_large() {
+    Trie* trie = trie_init();
+
+    // A reference corpus of realistic size: with a dense front of the double array, a first-fit
+    // search that rescans it for every node takes seconds here instead of a fraction of one
+    const size_t count = 150000;
+    char key[64];
+    for (size_t i = 0; i < count; ++i) {
+        size_t len = 4 + next_random() % 57;
+        for (size_t j = 0; j < len; ++j) {
+            key[j] = (char) (63 + next_random() % 64);
+        }
+        key[len] = '\0';
+        trie_add(trie, key);
+    }
+
+    clock_t start = clock();
+    FrozenTrie* frozen = trie_freeze(trie);
+    double seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+    TEST_CHECK_(seconds < 2.0, "freezing %zu keys took %.2f s", count, seconds);
+    TEST_ASSERT(frozen_trie_size(frozen) == trie_size(trie));
+
+    // Replay the same keys, and the same keys one character longer, which are missing
+    rand_x = 0x2545f4914f6cdd1d, rand_y = 0x9e3779b97f4a7c15, rand_c = 1;
+    for (size_t i = 0; i < count; ++i) {
+        size_t len = 4 + next_random() % 57;
+        for (size_t j = 0; j < len; ++j) {
+            key[j] = (char) (63 + next_random() % 64);
+        }
+        key[len] = '\0';
+        TEST_ASSERT(frozen_trie_search(frozen, key));
+        key[len] = '?';
+        key[len + 1] = '\0';
+        TEST_ASSERT(frozen_trie_search(frozen, key) == trie_search(trie, key));
+    }
+
+    frozen_trie_free(frozen);
+    trie_free(trie);
+}
 
 TEST_LIST = {
         { "Trie simple add",               test_trie_simple_add },
         { "Trie simple add and search",    test_trie_simple_add_search },
         { "Trie add ascending",            test_trie_ascending },
         { "Trie independent strings",      test_trie_independent_strings },
+        { "Trie prefix keys",              test_trie_prefix_keys },
+        { "Trie search rotation",          test_trie_search_rotation },
+        { "Trie insert batch",             test_trie_insert_batch },
+        { "Trie freeze",                   test_trie_freeze },
+        { "Trie freeze large",             test_trie_freeze_large },
         { NULL, NULL }
 };
\ No newline at end of file